@@ -1,93 +1,127 @@
 #include "color.h"
 #include "list.h"
 #include "polygon.h"
+#include "pool.h"
 #include "sdl_wrapper.h"
+#include "shape.h"
 #include "vector.h"
 #include <assert.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 typedef struct body {
-  list_t *vertices;
+  shape_kind_t kind;
+  // only used by circles
+  double radius;
+  // the shape relative to the centroid, before it is rotated by the angle,
+  // which may be shared with other bodies. It never changes, so turning the
+  // body again and again does not build up rounding error. Circles have none
+  // until their vertices are asked for
+  shape_t *shape;
+  // the shape where the body is now, allocated and rebuilt from the local
+  // shape only when it is asked for after the body has moved or turned
+  vertices_t world;
+  bool world_stale;
+  bool normals_stale;
+  // the cosine and sine of the angle
+  vector_t turn;
+  // the box and distance from the centroid enclosing the shape,
+  // which only change when the body turns, so collision tests can reject
+  // early without building the world vertices
+  aabb_t extent;
+  double bounding_radius;
   void *info;
   rgb_color_t color;
   double mass;
   vector_t velocity;
   vector_t position;
+  // the position before the last tick, for interpolated drawing
+  vector_t prev_position;
   double angle;
   vector_t force;
   vector_t impulse;
   vector_t acceleration;
   bool flag;
+  // asleep bodies are not ticked; see body_sleep().
+  // Static bodies sleep for good
+  bool asleep;
+  bool is_static;
+  // continuous bodies are swept over each tick; see body_set_continuous()
+  bool continuous;
+  size_t still_ticks;
   bool grav;
   bool prev;
   free_func_t info_freer;
+  // links from the force creators and other objects that depend on the body
+  list_t *links;
 } body_t;
 
-body_t *body_init(list_t *shape, double mass, rgb_color_t color) {
-  body_t *new_body = malloc(sizeof(body_t));
-  assert(new_body != NULL);
+const size_t BODY_SLAB_OBJECTS = 64;
+const size_t START_LOG_ENTRIES = 64;
 
-  new_body->vertices = shape;
-  new_body->color = color;
-  new_body->mass = mass;
-  vector_t init_velocity = VEC_ZERO;
-  new_body->velocity = init_velocity;
-  new_body->position = polygon_centroid(shape);
-  vector_t init_force = VEC_ZERO;
-  new_body->force = init_force;
-  vector_t init_impulse = VEC_ZERO;
-  new_body->impulse = init_impulse;
-  vector_t init_acceleration = VEC_ZERO;
-  new_body->acceleration = init_acceleration;
-  new_body->info_freer = NULL;
-  new_body->angle = 0.0;
-  new_body->info = NULL;
-  new_body->flag = 0;
-  new_body->grav = 0;
-  new_body->prev = 0;
+// bodies are created before they join a scene, so they share one pool.
+// Scenes may be ticked on different threads, so it is locked.
+static pool_t *body_pool = NULL;
+static pthread_mutex_t body_pool_lock = PTHREAD_MUTEX_INITIALIZER;
 
-  return new_body;
+typedef enum { LOG_ADD_FORCE, LOG_REMOVE_FORCE, LOG_ADD_IMPULSE } log_kind_t;
+
+typedef struct log_entry {
+  body_t *body;
+  vector_t value;
+  log_kind_t kind;
+} log_entry_t;
+
+typedef struct force_log {
+  log_entry_t *entries;
+  size_t size;
+  size_t capacity;
+} force_log_t;
+
+// where this thread's forces go instead of the bodies, if anywhere
+static _Thread_local force_log_t *deferred_forces = NULL;
+
+body_t *body_init(list_t *shape, double mass, rgb_color_t color) {
+  return body_init_with_info(shape, mass, color, NULL, NULL);
 }
 
 body_t *body_init_with_prev_grav_info(bool prev, bool grav_remover,
                                       list_t *shape, double mass,
                                       rgb_color_t color) {
-  body_t *new_body = malloc(sizeof(body_t));
-  assert(new_body != NULL);
-
-  new_body->vertices = shape;
-  new_body->color = color;
-  new_body->mass = mass;
-  vector_t init_velocity = VEC_ZERO;
-  new_body->velocity = init_velocity;
-  new_body->position = polygon_centroid(shape);
-  vector_t init_force = VEC_ZERO;
-  new_body->force = init_force;
-  vector_t init_impulse = VEC_ZERO;
-  new_body->impulse = init_impulse;
-  vector_t init_acceleration = VEC_ZERO;
-  new_body->acceleration = init_acceleration;
-  new_body->angle = 0.0;
-  new_body->flag = 0;
+  body_t *new_body = body_init_with_info(shape, mass, color, NULL, NULL);
   new_body->prev = prev;
   new_body->grav = grav_remover;
   return new_body;
 }
 
-body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
-                            void *info, free_func_t info_freer) {
-  body_t *new_body = malloc(sizeof(body_t));
-  assert(new_body != NULL);
-
-  new_body->vertices = shape;
+// takes a body from the pool and sets everything except its shape
+static body_t *body_alloc(double mass, rgb_color_t color, void *info,
+                          free_func_t info_freer) {
+  pthread_mutex_lock(&body_pool_lock);
+  if (body_pool == NULL) {
+    body_pool = pool_init(sizeof(body_t), BODY_SLAB_OBJECTS);
+  }
+  body_t *new_body = pool_alloc(body_pool);
+  pthread_mutex_unlock(&body_pool_lock);
+
+  new_body->kind = SHAPE_POLYGON;
+  new_body->radius = 0.0;
+  new_body->shape = NULL;
+  new_body->world = (vertices_t){.data = NULL, .size = 0, .normals = NULL};
+  new_body->world_stale = false;
+  new_body->normals_stale = false;
+  new_body->turn = (vector_t){.x = 1.0, .y = 0.0};
+  new_body->extent = (aabb_t){.min = VEC_ZERO, .max = VEC_ZERO};
+  new_body->bounding_radius = 0.0;
   new_body->color = color;
   new_body->mass = mass;
   vector_t init_velocity = VEC_ZERO;
   new_body->velocity = init_velocity;
-  new_body->position = polygon_centroid(shape);
+  new_body->position = VEC_ZERO;
+  new_body->prev_position = VEC_ZERO;
   vector_t init_force = VEC_ZERO;
   new_body->force = init_force;
   vector_t init_impulse = VEC_ZERO;
@@ -98,37 +132,224 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
   new_body->info_freer = info_freer;
   new_body->angle = 0.0;
   new_body->flag = 0;
+  new_body->asleep = false;
+  new_body->is_static = false;
+  new_body->continuous = false;
+  new_body->still_ticks = 0;
   new_body->grav = 0;
   new_body->prev = 0;
+  new_body->links = list_init(0, NULL);
+
+  return new_body;
+}
+
+// rotates a point relative to the centroid by the body's angle
+static vector_t body_rotate(body_t *body, vector_t point) {
+  return (vector_t){.x = point.x * body->turn.x - point.y * body->turn.y,
+                    .y = point.x * body->turn.y + point.y * body->turn.x};
+}
+
+// takes ownership of a reference to the body's local shape
+static void body_set_shape(body_t *body, shape_t *shape) {
+  body->shape = shape;
+  body->world.size = shape_get_vertices(shape).size;
+  body->world_stale = true;
+  body->normals_stale = true;
+}
+
+// recomputes the cached extent from the body's shape and angle
+static void body_update_extent(body_t *body) {
+  if (body->kind == SHAPE_CIRCLE) {
+    vector_t reach = {.x = body->radius, .y = body->radius};
+    body->extent = (aabb_t){.min = vec_negate(reach), .max = reach};
+    body->bounding_radius = body->radius;
+    return;
+  }
+  vertices_t local = shape_get_vertices(body->shape);
+  body->extent = (aabb_t){.min = VEC_ZERO, .max = VEC_ZERO};
+  double max_dist_squared = 0.0;
+  for (size_t i = 0; i < local.size; i++) {
+    vector_t offset = body_rotate(body, local.data[i]);
+    if (i == 0) {
+      body->extent = (aabb_t){.min = offset, .max = offset};
+    }
+    body->extent.min.x = fmin(body->extent.min.x, offset.x);
+    body->extent.min.y = fmin(body->extent.min.y, offset.y);
+    body->extent.max.x = fmax(body->extent.max.x, offset.x);
+    body->extent.max.y = fmax(body->extent.max.y, offset.y);
+    max_dist_squared = fmax(max_dist_squared, vec_dot(offset, offset));
+  }
+  body->bounding_radius = sqrt(max_dist_squared);
+}
+
+// turns the body about its centroid to an absolute angle
+static void body_turn(body_t *body, double angle) {
+  body_wake(body);
+  if (body->kind == SHAPE_BOX && angle != 0.0) {
+    body->kind = SHAPE_POLYGON;
+  }
+  body->angle = angle;
+  body->turn = (vector_t){.x = cos(angle), .y = sin(angle)};
+  body->world_stale = true;
+  body->normals_stale = true;
+  body_update_extent(body);
+}
+
+body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
+                            void *info, free_func_t info_freer) {
+  body_t *new_body = body_alloc(mass, color, info, info_freer);
+
+  // packs the shape so the vertices are contiguous, then drops the list
+  vertices_t vertices = vertices_from_list(shape);
+  list_free(shape);
+  new_body->position = vertices_centroid(vertices);
+  new_body->prev_position = new_body->position;
+  vertices_translate(vertices, vec_negate(new_body->position));
+  body_set_shape(new_body, shape_init_vertices(vertices, SHAPE_POLYGON));
+  body_update_extent(new_body);
+
+  return new_body;
+}
+
+body_t *body_init_circle(vector_t center, double radius, double mass,
+                         rgb_color_t color, void *info,
+                         free_func_t info_freer) {
+  assert(radius > 0.0);
+  body_t *new_body = body_alloc(mass, color, info, info_freer);
+  new_body->kind = SHAPE_CIRCLE;
+  new_body->radius = radius;
+  new_body->position = center;
+  new_body->prev_position = center;
+  body_update_extent(new_body);
+  return new_body;
+}
+
+body_t *body_init_box(vector_t center, double width, double height,
+                      double mass, rgb_color_t color, void *info,
+                      free_func_t info_freer) {
+  shape_t *shape = shape_init_box(width, height);
+  body_t *new_body =
+      body_init_shared(shape, center, mass, color, info, info_freer);
+  shape_release(shape);
+  return new_body;
+}
+
+body_t *body_init_shared(shape_t *shape, vector_t centroid, double mass,
+                         rgb_color_t color, void *info,
+                         free_func_t info_freer) {
+  body_t *new_body = body_alloc(mass, color, info, info_freer);
+  new_body->kind = shape_get_kind(shape);
+  if (new_body->kind == SHAPE_CIRCLE) {
+    new_body->radius = shape_get_radius(shape);
+  }
+  body_set_shape(new_body, shape_retain(shape));
+  new_body->position = centroid;
+  new_body->prev_position = centroid;
+  body_update_extent(new_body);
+  return new_body;
+}
 
+body_t *body_init_exact(shape_kind_t kind, shape_t *shape, double radius,
+                        vector_t centroid, double angle, double mass,
+                        rgb_color_t color, void *info,
+                        free_func_t info_freer) {
+  assert(shape != NULL || kind == SHAPE_CIRCLE);
+  body_t *new_body = body_alloc(mass, color, info, info_freer);
+  new_body->kind = kind;
+  new_body->radius = radius;
+  if (shape != NULL) {
+    body_set_shape(new_body, shape_retain(shape));
+  }
+  // kept as given rather than recomputed from the vertices, which may round
+  new_body->position = centroid;
+  new_body->prev_position = centroid;
+  body_turn(new_body, angle);
   return new_body;
 }
 
 void body_free(body_t *body) {
-  list_free(body->vertices);
+  // leaves the links in place but marks them as pointing at a freed body
+  for (size_t i = 0; i < list_size(body->links); i++) {
+    ((body_link_t *)list_get(body->links, i))->body = NULL;
+  }
+  list_free(body->links);
+  if (body->shape != NULL) {
+    shape_release(body->shape);
+  }
+  free(body->world.data);
+  free(body->world.normals);
   if (body->info_freer != NULL) {
     body->info_freer(body->info);
   }
-  free(body);
+  pthread_mutex_lock(&body_pool_lock);
+  pool_free(body);
+  pthread_mutex_unlock(&body_pool_lock);
 }
 
 list_t *body_get_shape(body_t *body) {
   // makes a deep copy
-  list_t *new_vertices = list_init(list_size(body->vertices), free);
-  for (size_t i = 0; i < list_size(body->vertices); i++) {
+  vertices_t vertices = body_get_vertices(body);
+  list_t *new_vertices = list_init(vertices.size, free);
+  for (size_t i = 0; i < vertices.size; i++) {
     vector_t *vertex = malloc(sizeof(vector_t));
-    vector_t *curr = list_get(body->vertices, i);
-    vertex->x = curr->x;
-    vertex->y = curr->y;
+    *vertex = vertices.data[i];
     list_add(new_vertices, vertex);
   }
   return new_vertices;
 }
 
-list_t *body_get_vertices(body_t *body) { return body->vertices; }
+shape_kind_t body_get_shape_kind(body_t *body) { return body->kind; }
+
+double body_get_radius(body_t *body) {
+  assert(body->kind == SHAPE_CIRCLE);
+  return body->radius;
+}
+
+vertices_t body_get_vertices(body_t *body) {
+  if (body->kind == SHAPE_CIRCLE && body->shape == NULL) {
+    body_set_shape(body, shape_init_circle(body->radius));
+  }
+  if (body->world.data == NULL) {
+    size_t size = body->world.size > 0 ? body->world.size : 1;
+    body->world.data = malloc(sizeof(vector_t) * size);
+    body->world.normals = malloc(sizeof(vector_t) * size);
+    assert(body->world.data != NULL && body->world.normals != NULL);
+  }
+  // built from the local shape every time rather than moved in place,
+  // so the result only depends on the centroid and angle
+  vertices_t local = shape_get_vertices(body->shape);
+  if (body->world_stale) {
+    for (size_t i = 0; i < local.size; i++) {
+      body->world.data[i] =
+          vec_add(body->position, body_rotate(body, local.data[i]));
+    }
+    body->world_stale = false;
+  }
+  if (body->normals_stale) {
+    for (size_t i = 0; i < local.size; i++) {
+      body->world.normals[i] = body_rotate(body, local.normals[i]);
+    }
+    body->normals_stale = false;
+  }
+  return body->world;
+}
+
+shape_t *body_get_local_shape(body_t *body) { return body->shape; }
+
+aabb_t body_get_bounds(body_t *body) {
+  return (aabb_t){.min = vec_add(body->position, body->extent.min),
+                  .max = vec_add(body->position, body->extent.max)};
+}
+
+double body_get_bounding_radius(body_t *body) { return body->bounding_radius; }
 
 vector_t body_get_centroid(body_t *body) { return body->position; }
 
+vector_t body_get_interpolated_centroid(body_t *body, double alpha) {
+  vector_t moved = vec_subtract(body->position, body->prev_position);
+  return vec_add(body->prev_position, vec_multiply(alpha, moved));
+}
+
 double body_get_mass(body_t *body) { return body->mass; }
 
 vector_t body_get_velocity(body_t *body) { return body->velocity; }
@@ -150,28 +371,62 @@ bool body_get_grav(body_t *body) { return body->grav; }
 
 void body_set_grav(body_t *body, bool grav) { body->grav = grav; }
 
-// moves centroid & all vertices accordingly
+// the world vertices are rebuilt when next needed
 void body_set_centroid(body_t *body, vector_t x) {
-  vector_t dist = vec_subtract(x, body->position);
-  polygon_translate(body->vertices, dist);
-
+  body_wake(body);
   body->position = x;
+  body->prev_position = x;
+  body->world_stale = true;
 }
 
-void body_set_velocity(body_t *body, vector_t v) { body->velocity = v; }
+void body_set_velocity(body_t *body, vector_t v) {
+  if (v.x != body->velocity.x || v.y != body->velocity.y) {
+    body_wake(body);
+  }
+  body->velocity = v;
+}
 
 void body_set_fake_rotation(body_t *body, double angle) {
-  polygon_rotate(body->vertices, 2 * M_PI - body->angle, body->position);
-  polygon_rotate(body->vertices, angle, body->position);
+  body_turn(body, angle);
+}
+
+void body_set_rotation(body_t *body, double angle) { body_turn(body, angle); }
+
+static void force_log_add(force_log_t *log, body_t *body, vector_t value,
+                          log_kind_t kind) {
+  if (log->size == log->capacity) {
+    log->capacity *= 2;
+    log->entries = realloc(log->entries, sizeof(log_entry_t) * log->capacity);
+    assert(log->entries != NULL);
+  }
+  log->entries[log->size++] =
+      (log_entry_t){.body = body, .value = value, .kind = kind};
 }
 
-void body_set_rotation(body_t *body, double angle) {
-  polygon_rotate(body->vertices, angle, body->position);
+// adds a force or impulse to a body's total. A sleeping body keeps the total
+// until it is big enough to wake it, so small pushes add up instead of being
+// lost; an infinite mass is never woken, and static bodies drop them all
+static void body_accumulate(body_t *body, vector_t *total, vector_t value,
+                            double limit) {
+  if (body->is_static) {
+    return;
+  }
+  *total = vec_add(*total, value);
+  if (!body->asleep) {
+    return;
+  }
+  double most = limit * body->mass;
+  if (vec_dot(*total, *total) > most * most) {
+    body_wake(body);
+  }
 }
 
 void body_add_force(body_t *body, vector_t force) {
-  vector_t old_force = body->force;
-  body->force = vec_add(old_force, force);
+  if (deferred_forces != NULL) {
+    force_log_add(deferred_forces, body, force, LOG_ADD_FORCE);
+    return;
+  }
+  body_accumulate(body, &body->force, force, SLEEP_ACCELERATION);
 }
 
 vector_t body_get_force(body_t *body) { return body->force; }
@@ -181,15 +436,25 @@ bool body_get_prev_collision(body_t *body) { return body->prev; }
 void body_set_prev_collision(body_t *body, bool prev) { body->prev = prev; }
 
 void body_remove_force(body_t *body, vector_t force) {
-  vector_t old_force = body->force;
-  body->force = vec_subtract(old_force, force);
+  if (deferred_forces != NULL) {
+    force_log_add(deferred_forces, body, force, LOG_REMOVE_FORCE);
+    return;
+  }
+  body_accumulate(body, &body->force, vec_multiply(-1.0, force),
+                  SLEEP_ACCELERATION);
 }
 
 void body_add_impulse(body_t *body, vector_t impulse) {
-  body->impulse = vec_add(body->impulse, impulse);
+  if (deferred_forces != NULL) {
+    force_log_add(deferred_forces, body, impulse, LOG_ADD_IMPULSE);
+    return;
+  }
+  body_accumulate(body, &body->impulse, impulse, SLEEP_SPEED);
 }
 
-void body_set_angle(body_t *body, double angle) { body->angle = angle; }
+vector_t body_get_impulse(body_t *body) { return body->impulse; }
+
+void body_set_angle(body_t *body, double angle) { body_turn(body, angle); }
 
 double body_get_angle(body_t *body) { return body->angle; }
 
@@ -198,25 +463,132 @@ void body_reset_force(body_t *body) {
 }
 
 void body_tick(body_t *body, double dt) {
+  body->prev_position = body->position;
   // finds acceleration then velocity and dist and sets new velocity
   body->acceleration = vec_multiply(1.0 / (body->mass), body->force);
   vector_t old_vel = body_get_velocity(body);
   vector_t older_vel = vec_add(old_vel, vec_multiply(dt, body->acceleration));
   vector_t new_vel =
       vec_add(older_vel, vec_multiply(1.0 / body->mass, body->impulse));
-  body_set_velocity(body, new_vel);
+  body->velocity = new_vel;
 
   vector_t avg_velocity = vec_multiply(0.5, vec_add(old_vel, new_vel));
   vector_t dist = vec_multiply(dt, avg_velocity);
 
-  // translates vertices and position
-  polygon_translate(body->vertices, dist);
-  vector_t old_position = body->position;
-  body->position = vec_add(old_position, dist);
+  // only moves the centroid; the vertices and bounds follow it when asked for
+  body->position = vec_add(body->position, dist);
+  body->world_stale = true;
   body->force = (vector_t){.x = 0.0, .y = 0.0};
   body->impulse = (vector_t){.x = 0.0, .y = 0.0};
 }
 
+void body_rewind(body_t *body, double fraction) {
+  assert(fraction >= 0.0 && fraction <= 1.0);
+  vector_t moved = vec_subtract(body->position, body->prev_position);
+  body->position = vec_add(body->prev_position, vec_multiply(fraction, moved));
+  body->world_stale = true;
+}
+
+void body_set_continuous(body_t *body, bool continuous) {
+  body->continuous = continuous;
+}
+
+bool body_is_continuous(body_t *body) { return body->continuous; }
+
 void body_remove(body_t *body) { body->flag = true; }
 
 bool body_is_removed(body_t *body) { return body->flag; }
+
+void body_sleep(body_t *body) {
+  body->asleep = true;
+  body->velocity = VEC_ZERO;
+  body->force = VEC_ZERO;
+  body->impulse = VEC_ZERO;
+  // keeps interpolated drawing from wobbling between the last two positions
+  body->prev_position = body->position;
+}
+
+void body_wake(body_t *body) {
+  if (body->is_static) {
+    return;
+  }
+  body->asleep = false;
+  body->still_ticks = 0;
+}
+
+bool body_is_asleep(body_t *body) { return body->asleep; }
+
+void body_set_static(body_t *body) {
+  body_sleep(body);
+  body->is_static = true;
+}
+
+bool body_is_static(body_t *body) { return body->is_static; }
+
+size_t body_get_still_ticks(body_t *body) { return body->still_ticks; }
+
+void body_set_still_ticks(body_t *body, size_t ticks) {
+  body->still_ticks = ticks;
+}
+
+void body_link(body_t *body, body_link_t *link, void *owner) {
+  link->owner = owner;
+  link->body = body;
+  link->index = list_size(body->links);
+  list_add(body->links, link);
+}
+
+void body_unlink(body_link_t *link) {
+  if (link->body == NULL) {
+    return;
+  }
+  list_t *links = link->body->links;
+  assert(list_get(links, link->index) == link);
+  list_swap_remove(links, link->index);
+  // the last link was moved into the freed slot
+  if (link->index < list_size(links)) {
+    ((body_link_t *)list_get(links, link->index))->index = link->index;
+  }
+  link->body = NULL;
+}
+
+list_t *body_get_links(body_t *body) { return body->links; }
+
+force_log_t *force_log_init(void) {
+  force_log_t *log = malloc(sizeof(force_log_t));
+  assert(log != NULL);
+  log->entries = malloc(sizeof(log_entry_t) * START_LOG_ENTRIES);
+  assert(log->entries != NULL);
+  log->size = 0;
+  log->capacity = START_LOG_ENTRIES;
+  return log;
+}
+
+void force_log_free(force_log_t *log) {
+  free(log->entries);
+  free(log);
+}
+
+void force_log_apply(force_log_t *log) {
+  // goes through the same functions so the arithmetic matches exactly
+  force_log_t *deferred = deferred_forces;
+  deferred_forces = NULL;
+  for (size_t i = 0; i < log->size; i++) {
+    log_entry_t *entry = &log->entries[i];
+    switch (entry->kind) {
+    case LOG_ADD_FORCE:
+      body_add_force(entry->body, entry->value);
+      break;
+    case LOG_REMOVE_FORCE:
+      body_remove_force(entry->body, entry->value);
+      break;
+    case LOG_ADD_IMPULSE:
+      body_add_impulse(entry->body, entry->value);
+      break;
+    }
+  }
+  deferred_forces = deferred;
+  log->size = 0;
+}
+
+void body_defer_forces(force_log_t *log) { deferred_forces = log; }
@@ -3,12 +3,14 @@
 
 #include "color.h"
 #include "list.h"
+#include "polygon.h"
+#include "shape.h"
 #include "vector.h"
 #include <stdbool.h>
 
 /**
  * A rigid body constrained to the plane.
- * Implemented as a polygon with uniform density.
+ * Implemented as a polygon, circle or axis-aligned box with uniform density.
  * Bodies can accumulate forces and impulses during each tick.
  * Angular physics (i.e. torques) are not currently implemented.
  */
@@ -28,6 +30,8 @@ body_t *body_init_with_prev_grav_info(bool prev, bool grav_remover,
  * Allocates memory for a body with the given parameters.
  * The body is initially at rest.
  * Asserts that the mass is positive and that the required memory is allocated.
+ * The body copies the shape into its own packed vertex array
+ * and frees the list, so the list must not be used afterwards.
  *
  * @param shape a list of vectors describing the initial shape of the body
  * @param mass the mass of the body (if INFINITY, stops the body from moving)
@@ -40,6 +44,84 @@ body_t *body_init_with_prev_grav_info(bool prev, bool grav_remover,
 body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
                             void *info, free_func_t info_freer);
 
+/**
+ * Allocates memory for a circular body.
+ * Acts like body_init_with_info(), but the body stores no vertices
+ * until body_get_vertices() is called on it.
+ *
+ * @param center the centroid of the circle
+ * @param radius the radius of the circle
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_circle(vector_t center, double radius, double mass,
+                         rgb_color_t color, void *info,
+                         free_func_t info_freer);
+
+/**
+ * Allocates memory for an axis-aligned rectangular body.
+ * Acts like body_init_with_info() with a four-vertex rectangle.
+ * Rotating the body turns it into an ordinary polygon.
+ *
+ * @param center the centroid of the rectangle
+ * @param width the size of the rectangle along the x-axis
+ * @param height the size of the rectangle along the y-axis
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_box(vector_t center, double width, double height,
+                      double mass, rgb_color_t color, void *info,
+                      free_func_t info_freer);
+
+/**
+ * Allocates memory for a body with a shape that may be shared with
+ * any number of other bodies, e.g. every brick in a wall.
+ * Acts like body_init_with_info(), but the body takes a reference to the
+ * shape instead of storing its own copy of the vertices.
+ *
+ * @param shape the body's shape relative to its centroid
+ * @param centroid where to put the shape's centroid
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_shared(shape_t *shape, vector_t centroid, double mass,
+                         rgb_color_t color, void *info,
+                         free_func_t info_freer);
+
+/**
+ * Allocates memory for a body with exactly the given shape, centroid and
+ * angle, e.g. to recreate a body saved earlier.
+ * Unlike body_init_with_info(), the shape is given relative to the centroid,
+ * as returned by body_get_local_shape(), so the body matches the saved
+ * one bit for bit.
+ *
+ * @param kind the kind of shape, which may differ from the shape's own kind,
+ *   e.g. for a box that has been rotated
+ * @param shape the body's shape, which the body takes a reference to;
+ *   NULL for a circle whose vertices have not been asked for
+ * @param radius the radius of a circle, ignored for other shapes
+ * @param centroid the centroid of the body
+ * @param angle the angle the shape is rotated by about the centroid
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_exact(shape_kind_t kind, shape_t *shape, double radius,
+                        vector_t centroid, double angle, double mass,
+                        rgb_color_t color, void *info,
+                        free_func_t info_freer);
+
 /**
  * Releases the memory allocated for a body.
  *
@@ -57,15 +139,70 @@ void body_free(body_t *body);
 list_t *body_get_shape(body_t *body);
 
 /**
- * Gets the vertices of a body
+ * Gets the kind of shape a body has.
  *
  * @param body a pointer to a body returned from body_init()
- * @return list_t of vertices of body
+ * @return SHAPE_POLYGON, SHAPE_CIRCLE or SHAPE_BOX
  */
-list_t *body_get_vertices(body_t *body);
+shape_kind_t body_get_shape_kind(body_t *body);
 
 /**
- * Sets the angle of a body
+ * Gets the radius of a circular body.
+ *
+ * @param body a pointer to a body returned from body_init_circle()
+ * @return the radius of the circle
+ */
+double body_get_radius(body_t *body);
+
+/**
+ * Gets the vertices of a body.
+ * The body keeps its shape relative to its centroid and only works out
+ * where the vertices are now when they are asked for after it has moved
+ * or turned, so this takes time linear in the number of vertices at most
+ * once per move. The array is stored inside the body and is not copied,
+ * so it is only valid until the body moves or is freed, and the body must
+ * not be asked for its vertices from two threads at once.
+ * A circle is approximated by a regular polygon, built the first time
+ * its vertices are requested.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's current vertices
+ */
+vertices_t body_get_vertices(body_t *body);
+
+/**
+ * Gets the shape of a body relative to its centroid, before it is rotated
+ * by the body's angle. This never changes as the body moves or turns.
+ * No reference is taken; see shape_retain().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's shape, which may be shared with other bodies;
+ *   NULL for a circle until body_get_vertices() is called on it
+ */
+shape_t *body_get_local_shape(body_t *body);
+
+/**
+ * Gets the axis-aligned bounding box of a body's current shape.
+ * The box around the centroid is cached whenever the body turns,
+ * so this takes constant time.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the smallest box containing the body
+ */
+aabb_t body_get_bounds(body_t *body);
+
+/**
+ * Gets the radius of the smallest circle around a body's centroid
+ * that contains its shape. Like the bounds, this is cached.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the largest distance from the centroid to the shape
+ */
+double body_get_bounding_radius(body_t *body);
+
+/**
+ * Sets the angle of a body, rotating its shape about its centroid.
+ * Same as body_set_rotation().
  *
  * @param body a pointer to a body returned from body_init()
  * @param angle the angle to set the body to
@@ -73,7 +210,9 @@ list_t *body_get_vertices(body_t *body);
 void body_set_angle(body_t *body, double angle);
 
 /**
- * Rotates a body by first rotating it back to its original position
+ * Rotates a body to an absolute angle. Same as body_set_rotation();
+ * since the shape is always rotated from its original orientation,
+ * there is no need to rotate it back first.
  *
  * @param body a pointer to a body returned from body_init()
  * @param angle the angle to set the body to
@@ -98,6 +237,18 @@ double body_get_angle(body_t *body);
  */
 vector_t body_get_centroid(body_t *body);
 
+/**
+ * Gets a point between a body's centroid before and after its last tick,
+ * for drawing the body between ticks when physics runs at a fixed rate.
+ * Moving the body with body_set_centroid() is not interpolated.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param alpha how far through the last tick to go, from 0 (its start)
+ *   to 1 (its end, i.e. the current centroid)
+ * @return the interpolated centroid
+ */
+vector_t body_get_interpolated_centroid(body_t *body, double alpha);
+
 /**
  * Gets the current velocity of a body.
  *
@@ -213,6 +364,14 @@ void body_remove_force(body_t *body, vector_t force);
  */
 void body_add_impulse(body_t *body, vector_t impulse);
 
+/**
+ * Gets the impulse a body has accumulated since its last tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the sum of the impulses added with body_add_impulse()
+ */
+vector_t body_get_impulse(body_t *body);
+
 /**
  * Updates the body after a given time interval has elapsed.
  * Sets acceleration and velocity according to the forces and impulses
@@ -226,6 +385,40 @@ void body_add_impulse(body_t *body, vector_t impulse);
  */
 void body_tick(body_t *body, double dt);
 
+/**
+ * Moves a body back along the straight path it took during its last tick,
+ * e.g. to where it first touched something on the way. Its velocity is
+ * left as it is.
+ *
+ * @param body the body to move
+ * @param fraction how far along the path to leave the body, from 0 for
+ *   where it started the tick to 1 for where it is now
+ */
+void body_rewind(body_t *body, double fraction);
+
+/**
+ * Turns continuous collision detection on or off for a body.
+ * After each tick, scene_tick() sweeps a continuous body's shape along the
+ * path it took, so a fast body stops where it first touched something it
+ * has a collision with instead of passing through it between ticks.
+ * That collision is then handled on the next tick, as usual.
+ * Bodies are not continuous by default, since sweeping costs a narrow phase
+ * test per step along the path. Only the path of the body's centroid is
+ * swept, not its turning.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param continuous whether the body should be swept
+ */
+void body_set_continuous(body_t *body, bool continuous);
+
+/**
+ * Returns whether a body is swept over each tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the value last passed to body_set_continuous(), or false
+ */
+bool body_is_continuous(body_t *body);
+
 /**
  * Marks a body for removal--future calls to body_is_removed() will return true.
  * Does not free the body.
@@ -245,4 +438,168 @@ void body_remove(body_t *body);
  */
 bool body_is_removed(body_t *body);
 
+/**
+ * Sleeping: scene_tick() puts a body to sleep once it has stayed still for
+ * SLEEP_TICKS ticks in a row, or after one tick if its mass is INFINITY,
+ * and stops moving it and testing it against other sleeping bodies.
+ * A body is still while its speed is at most SLEEP_SPEED and the force on it
+ * would accelerate it by at most SLEEP_ACCELERATION.
+ * Build with -DSLEEP_TICKS=0 to keep every body awake.
+ */
+#ifndef SLEEP_TICKS
+#define SLEEP_TICKS 60
+#endif
+#ifndef SLEEP_SPEED
+#define SLEEP_SPEED 1e-2
+#endif
+#ifndef SLEEP_ACCELERATION
+#define SLEEP_ACCELERATION 1e-2
+#endif
+
+/**
+ * Puts a body to sleep, stopping it where it is.
+ * Until it is woken, the forces and impulses added to it are summed up
+ * rather than applied. Once either sum could make it move faster than the
+ * sleep thresholds, it wakes and the sums are applied on its next tick,
+ * so many small pushes still move it in the end. It is also woken by
+ * body_set_velocity() with a new velocity, body_set_centroid() and
+ * rotating the body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_sleep(body_t *body);
+
+/**
+ * Wakes a body, so it is ticked again and counts as moving.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_wake(body_t *body);
+
+/**
+ * Returns whether a body is asleep.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether body_sleep() has been called since the body last woke
+ */
+bool body_is_asleep(body_t *body);
+
+/**
+ * Makes a body static: it is put to sleep for good, so it never moves and
+ * forces and impulses on it are dropped. Scenes keep static bodies apart
+ * from the rest; see scene_add_static_body(). A static body must not be
+ * moved or rotated afterwards.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_set_static(body_t *body);
+
+/**
+ * Returns whether a body is static.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether body_set_static() has been called on the body
+ */
+bool body_is_static(body_t *body);
+
+/**
+ * Gets how many ticks in a row a body has stayed still,
+ * as counted by scene_tick() to decide when to put it to sleep.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the number of still ticks, which is reset when the body wakes
+ */
+size_t body_get_still_ticks(body_t *body);
+
+/**
+ * Sets how many ticks in a row a body has stayed still.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param ticks the number of still ticks
+ */
+void body_set_still_ticks(body_t *body, size_t ticks);
+
+/**
+ * A reference to a body from something that depends on it, e.g. a force.
+ * Each body keeps a list of the links that refer to it, so when the body is
+ * removed, everything depending on it can be found without a search.
+ */
+typedef struct body_link {
+  /** The object holding the link */
+  void *owner;
+  /** The body the link refers to, or NULL once the body has been freed */
+  body_t *body;
+  /** The position of the link in the body's list of links */
+  size_t index;
+} body_link_t;
+
+/**
+ * Attaches a link to a body, recording the body in the link.
+ * The link is not copied, so it must stay valid until it is unlinked
+ * or the body is freed.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param link the link to attach
+ * @param owner the object holding the link
+ */
+void body_link(body_t *body, body_link_t *link, void *owner);
+
+/**
+ * Detaches a link from the body it refers to in constant time.
+ * Does nothing if the body has already been freed.
+ *
+ * @param link a link attached with body_link()
+ */
+void body_unlink(body_link_t *link);
+
+/**
+ * Gets the links that currently refer to a body.
+ * The list is owned by the body and must not be modified directly.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the list of body_link_t pointers attached to the body
+ */
+list_t *body_get_links(body_t *body);
+
+/**
+ * A record of forces and impulses to apply to bodies later, in order.
+ * Force creators running on several threads each record into their own log,
+ * and replaying the logs in a fixed order adds every force in the same
+ * sequence as running the creators one after another.
+ */
+typedef struct force_log force_log_t;
+
+/**
+ * Allocates memory for an empty force log.
+ * Asserts that the required memory is allocated.
+ *
+ * @return a pointer to the newly allocated log
+ */
+force_log_t *force_log_init(void);
+
+/**
+ * Releases the memory allocated for a force log.
+ *
+ * @param log a pointer to a log returned from force_log_init()
+ */
+void force_log_free(force_log_t *log);
+
+/**
+ * Applies every force and impulse in a log, in the order they were recorded,
+ * then empties the log.
+ *
+ * @param log a pointer to a log returned from force_log_init()
+ */
+void force_log_apply(force_log_t *log);
+
+/**
+ * Redirects the calling thread's body_add_force(), body_remove_force() and
+ * body_add_impulse() calls into a log instead of the bodies.
+ * Other threads are not affected.
+ *
+ * @param log a pointer to a log returned from force_log_init(),
+ *   or NULL to apply forces directly again
+ */
+void body_defer_forces(force_log_t *log);
+
 #endif // #ifndef __BODY_H__
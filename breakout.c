@@ -3,6 +3,7 @@
 #include "list.h"
 #include "polygon.h"
 #include "sdl_wrapper.h"
+#include "shape.h"
 #include "state.h"
 #include "vector.h"
 #include <assert.h>
@@ -22,9 +23,6 @@ const vector_t WINDOW_TOP_LEFT = {.x = 0, .y = 500};
 const vector_t WINDOW_BOTTOM_RIGHT = {.x = 1000, .y = 0};
 const size_t NUM_ROWS = 3;
 const size_t NUM_COLUMNS = 10;
-// miscellaneous constants
-const float PI = M_PI;
-const size_t HALF_CIRCLE = 180;
 // brick constants
 const double BRICK_LENGTH = 89;
 const double BRICK_HEIGHT = 18;
@@ -58,167 +56,43 @@ typedef struct state {
   scene_t *body_list;
   double time;
   size_t counter;
+  // every brick is the same rectangle, so they all share one shape
+  shape_t *brick_shape;
 } state_t;
 
-body_t *make_brick(size_t center_x, size_t center_y, rgb_color_t color) {
-  // make list & add vertices of rectangle
-  list_t *vertices = list_init(4, free);
-  assert(vertices != NULL);
-
-  vector_t *pt1 = malloc(sizeof(vector_t));
-  *pt1 = (vector_t){.x = center_x + (BRICK_LENGTH / 2),
-                    .y = center_y + (BRICK_HEIGHT / 2)};
-  list_add(vertices, pt1);
-
-  vector_t *pt2 = malloc(sizeof(vector_t));
-  *pt2 = (vector_t){.x = center_x - (BRICK_LENGTH / 2),
-                    .y = center_y + (BRICK_HEIGHT / 2)};
-  list_add(vertices, pt2);
-
-  vector_t *pt3 = malloc(sizeof(vector_t));
-  *pt3 = (vector_t){.x = center_x - (BRICK_LENGTH / 2),
-                    .y = center_y - (BRICK_HEIGHT / 2)};
-  list_add(vertices, pt3);
-
-  vector_t *pt4 = malloc(sizeof(vector_t));
-  *pt4 = (vector_t){.x = center_x + (BRICK_LENGTH / 2),
-                    .y = center_y - (BRICK_HEIGHT / 2)};
-  list_add(vertices, pt4);
-
-  body_t *brick =
-      body_init_with_info(vertices, BRICK_MASS, color, "brick", NULL);
-
-  // add center point to verticies
+body_t *make_brick(state_t *state, size_t center_x, size_t center_y,
+                   rgb_color_t color) {
   vector_t center = (vector_t){.x = center_x, .y = center_y};
-  body_set_centroid(brick, center);
-  return brick;
+  return body_init_shared(state->brick_shape, center, BRICK_MASS, color,
+                          "brick", NULL);
 }
 
 body_t *make_main_body(size_t center_x, size_t center_y) {
-  // make list & add vertices of rectangle
-  list_t *vertices = list_init(4, free);
-  assert(vertices != NULL);
-
-  vector_t *pt1 = malloc(sizeof(vector_t));
-  *pt1 = (vector_t){.x = center_x + (MAIN_BODY_LENGTH / 2),
-                    .y = center_y + (MAIN_BODY_HEIGHT / 2)};
-  list_add(vertices, pt1);
-
-  vector_t *pt2 = malloc(sizeof(vector_t));
-  *pt2 = (vector_t){.x = center_x - (MAIN_BODY_LENGTH / 2),
-                    .y = center_y + (MAIN_BODY_HEIGHT / 2)};
-  list_add(vertices, pt2);
-
-  vector_t *pt3 = malloc(sizeof(vector_t));
-  *pt3 = (vector_t){.x = center_x - (MAIN_BODY_LENGTH / 2),
-                    .y = center_y - (MAIN_BODY_HEIGHT / 2)};
-  list_add(vertices, pt3);
-
-  vector_t *pt4 = malloc(sizeof(vector_t));
-  *pt4 = (vector_t){.x = center_x + (MAIN_BODY_LENGTH / 2),
-                    .y = center_y - (MAIN_BODY_HEIGHT / 2)};
-  list_add(vertices, pt4);
-
-  body_t *main_body = body_init_with_info(vertices, MAIN_BODY_MASS,
-                                          MAIN_BODY_COLOR, "main", NULL);
-
-  // add center point to verticies
   vector_t center = (vector_t){.x = center_x, .y = center_y};
-  body_set_centroid(main_body, center);
-  return main_body;
+  return body_init_box(center, MAIN_BODY_LENGTH, MAIN_BODY_HEIGHT,
+                       MAIN_BODY_MASS, MAIN_BODY_COLOR, "main", NULL);
 }
 
 body_t *make_ball(size_t center_x, size_t center_y) {
-  size_t num_points = 360;
-  list_t *vertices = list_init(num_points, free);
-  assert(vertices != NULL);
-
-  double x;
-  double y;
-
-  // make circle
-  for (size_t i = 1; i < num_points; i++) {
-    double curr_angle = ((i + 29) * PI) / HALF_CIRCLE;
-    x = cos(curr_angle) * BALL_RADIUS + center_x;
-    y = sin(curr_angle) * BALL_RADIUS + center_y;
-    vector_t *vec_ptr = malloc(sizeof(vector_t));
-    *vec_ptr = (vector_t){.x = x, .y = y};
-    list_add(vertices, vec_ptr);
-  }
-
-  body_t *ball =
-      body_init_with_info(vertices, BALL_MASS, BALL_COLOR, "ball", NULL);
-
   vector_t center = (vector_t){.x = center_x, .y = center_y};
-  body_set_centroid(ball, center);
+  body_t *ball = body_init_circle(center, BALL_RADIUS, BALL_MASS, BALL_COLOR,
+                                  "ball", NULL);
   body_set_velocity(ball, BALL_VEL);
+  // the ball is fast enough to pass through a brick between slow frames
+  body_set_continuous(ball, true);
   return ball;
 }
 
 body_t *make_vertical_wall(size_t center_x, size_t center_y) {
-  list_t *vertices = list_init(4, free);
-  assert(vertices != NULL);
-
-  vector_t *pt1 = malloc(sizeof(vector_t));
-  *pt1 = (vector_t){.x = center_x + (WALL_WIDTH / 2),
-                    .y = center_y + (WINDOW_MAX.y / 2)};
-  list_add(vertices, pt1);
-
-  vector_t *pt2 = malloc(sizeof(vector_t));
-  *pt2 = (vector_t){.x = center_x - (WALL_WIDTH / 2),
-                    .y = center_y + (WINDOW_MAX.y / 2)};
-  list_add(vertices, pt2);
-
-  vector_t *pt3 = malloc(sizeof(vector_t));
-  *pt3 = (vector_t){.x = center_x - (WALL_WIDTH / 2),
-                    .y = center_y - (WINDOW_MAX.y / 2)};
-  list_add(vertices, pt3);
-
-  vector_t *pt4 = malloc(sizeof(vector_t));
-  *pt4 = (vector_t){.x = center_x + (WALL_WIDTH / 2),
-                    .y = center_y - (WINDOW_MAX.y / 2)};
-  list_add(vertices, pt4);
-
-  body_t *vertical_wall =
-      body_init_with_info(vertices, WALL_MASS, WALL_COLOR, "wall", NULL);
-
-  // add center point to verticies
   vector_t center = (vector_t){.x = center_x, .y = center_y};
-  body_set_centroid(vertical_wall, center);
-  return vertical_wall;
+  return body_init_box(center, WALL_WIDTH, WINDOW_MAX.y, WALL_MASS, WALL_COLOR,
+                       "wall", NULL);
 }
 
 body_t *make_horizontal_wall(size_t center_x, size_t center_y) {
-  list_t *vertices = list_init(4, free);
-  assert(vertices != NULL);
-
-  vector_t *pt1 = malloc(sizeof(vector_t));
-  *pt1 = (vector_t){.x = center_x + (WINDOW_MAX.x / 2),
-                    .y = center_y + (WALL_WIDTH / 2)};
-  list_add(vertices, pt1);
-
-  vector_t *pt2 = malloc(sizeof(vector_t));
-  *pt2 = (vector_t){.x = center_x - (WINDOW_MAX.x / 2),
-                    .y = center_y + (WALL_WIDTH / 2)};
-  list_add(vertices, pt2);
-
-  vector_t *pt3 = malloc(sizeof(vector_t));
-  *pt3 = (vector_t){.x = center_x - (WINDOW_MAX.x / 2),
-                    .y = center_y - (WALL_WIDTH / 2)};
-  list_add(vertices, pt3);
-
-  vector_t *pt4 = malloc(sizeof(vector_t));
-  *pt4 = (vector_t){.x = center_x + (WINDOW_MAX.x / 2),
-                    .y = center_y - (WALL_WIDTH / 2)};
-  list_add(vertices, pt4);
-
-  body_t *horizontal_wall =
-      body_init_with_info(vertices, WALL_MASS, WALL_COLOR, "wall", NULL);
-
-  // add center point to verticies
   vector_t center = (vector_t){.x = center_x, .y = center_y};
-  body_set_centroid(horizontal_wall, center);
-  return horizontal_wall;
+  return body_init_box(center, WINDOW_MAX.x, WALL_WIDTH, WALL_MASS, WALL_COLOR,
+                       "wall", NULL);
 }
 
 // This function tests if the user hits the left or right side of the window
@@ -259,7 +133,8 @@ void make_singular_row(state_t *state) {
   size_t j = scene_bodies(state->body_list);
   for (size_t i = 0; i < NUM_COLUMNS; i++) {
     scene_add_body(state->body_list,
-                   make_brick(x - (BRICK_LENGTH / 2) * i, y, BRICK_COLOR));
+                   make_brick(state, x - (BRICK_LENGTH / 2) * i, y,
+                              BRICK_COLOR));
     create_half_destructive_collision(state->body_list, elasticity,
                                       scene_get_body(state->body_list, j),
                                       scene_get_body(state->body_list, 0));
@@ -320,13 +195,14 @@ void spawn_bricks(state_t *state) {
   double y = WINDOW_MAX.y - 15;
   for (int i = 0; i < NUM_COLUMNS; i++) {
     scene_add_body(state->body_list,
-                   make_brick(x - (BRICK_LENGTH / 2) * i, y, BRICK_COLOR));
+                   make_brick(state, x - (BRICK_LENGTH / 2) * i, y,
+                              BRICK_COLOR));
     scene_add_body(state->body_list,
-                   make_brick(x - (BRICK_LENGTH / 2) * i,
+                   make_brick(state, x - (BRICK_LENGTH / 2) * i,
                               y - (BRICK_HEIGHT / 2) - BRICK_Y_INCREMENT,
                               BRICK_COLOR));
     scene_add_body(state->body_list,
-                   make_brick(x - (BRICK_LENGTH / 2) * i,
+                   make_brick(state, x - (BRICK_LENGTH / 2) * i,
                               y - ((BRICK_HEIGHT / 2) + BRICK_Y_INCREMENT) * 2,
                               BRICK_COLOR));
     x += (BRICK_LENGTH + BRICK_X_INCREMENT);
@@ -457,6 +333,7 @@ state_t *emscripten_init() {
   state->body_list = scene_init();
   state->time = 0.0;
   state->counter = 0;
+  state->brick_shape = shape_init_box(BRICK_LENGTH, BRICK_HEIGHT);
   sdl_init(WINDOW_MIN, WINDOW_MAX);
   // first make the ball so that it is at index 0
   scene_add_body(
@@ -483,8 +360,7 @@ state_t *emscripten_init() {
   */
   ball_collision(state);
   for (size_t i = 0; i < scene_bodies(state->body_list); i++) {
-    sdl_draw_polygon(body_get_vertices(scene_get_body(state->body_list, i)),
-                     body_get_color(scene_get_body(state->body_list, i)));
+    sdl_draw_body(scene_get_body(state->body_list, i));
   }
   // printf("%f\n", body_get_centroid(scene_get_body(state->body_list, 1)).x);
   // printf("%f\n", body_get_centroid(scene_get_body(state->body_list, 1)).y);
@@ -507,8 +383,7 @@ void emscripten_main(state_t *state) {
   check_hit_walls(state);
   scene_tick(state->body_list, dt);
   for (size_t i = 0; i < scene_bodies(state->body_list); i++) {
-    sdl_draw_polygon(body_get_vertices(scene_get_body(state->body_list, i)),
-                     body_get_color(scene_get_body(state->body_list, i)));
+    sdl_draw_body(scene_get_body(state->body_list, i));
   }
   sdl_show();
 }
@@ -516,5 +391,6 @@ void emscripten_main(state_t *state) {
 // frees the state
 void emscripten_free(state_t *state) {
   scene_free(state->body_list);
+  shape_release(state->brick_shape);
   free(state);
 }
@@ -1,50 +1,116 @@
 #include "collision.h"
+#include "body.h"
 #include "list.h"
+#include "polygon.h"
+#include "stats.h"
+#include "trace.h"
 #include "vector.h"
 #include <assert.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
-// find separation axis
+// the most samples and halvings find_time_of_impact() takes for one pair
+const size_t TOI_MAX_STEPS = 256;
+const size_t TOI_BISECTIONS = 16;
+
+// find separation axis, the same way as vertices_edge_normals()
 vector_t find_separation_axis(vector_t v1, vector_t v2) {
-  vector_t direction = vec_rotate(vec_subtract(v1, v2), M_PI / 2);
-  double length = sqrt(pow(v1.x - v2.x, 2) + pow(v1.y - v2.y, 2));
-  return vec_multiply(1 / length, direction);
+  vector_t edge = vec_subtract(v1, v2);
+  double scale = 1 / sqrt(edge.x * edge.x + edge.y * edge.y);
+  return (vector_t){.x = -edge.y * scale, .y = edge.x * scale};
 }
 
-// find projection min
-double find_projection_min(list_t *shape, vector_t axis) {
-  // initialize
-  double dot_min = INFINITY;
-
-  // loop through each vertex
-  for (size_t i = 0; i < list_size(shape); i++) {
-    // find dot product
-    vector_t curr_vec = *((vector_t *)list_get(shape, i));
-    // compare
-    if (vec_dot(curr_vec, axis) < dot_min) {
-      dot_min = vec_dot(curr_vec, axis);
-    }
+// gets the separation axis for an edge, using the cached normal if any
+static vector_t get_edge_axis(vertices_t shape, size_t i) {
+  if (shape.normals != NULL) {
+    return shape.normals[i];
   }
-  return dot_min;
+  return find_separation_axis(shape.data[i],
+                              shape.data[(i + 1) % shape.size]);
 }
 
-// find projection max
-double find_projection_max(list_t *shape, vector_t axis) {
-  // initialize
+// the kernels below read vertices as an array of interleaved x, y doubles
+_Static_assert(sizeof(vector_t) == 2 * sizeof(double),
+               "vector_t must be two packed doubles");
+
+// finds the smallest and largest projections of a shape onto an axis
+// in one pass, projecting several vertices at a time where SIMD is available
+void find_projection_bounds(vertices_t shape, vector_t axis, double *min,
+                            double *max) {
+  double dot_min = INFINITY;
   double dot_max = -INFINITY;
-  // loop through each vertex
-  for (size_t i = 0; i < list_size(shape); i++) {
-    // find dot product
-    vector_t curr_vec = *((vector_t *)list_get(shape, i));
-    // compare
-    if (vec_dot(curr_vec, axis) > dot_max) {
-      dot_max = vec_dot(curr_vec, axis);
+  const double *coords = (const double *)shape.data;
+  size_t i = 0;
+
+#if defined(__AVX2__)
+  // four vertices per step: (x0 y0 x1 y1), (x2 y2 x3 y3) -> four dots
+  if (shape.size >= 4) {
+    __m256d axis_x = _mm256_set1_pd(axis.x);
+    __m256d axis_y = _mm256_set1_pd(axis.y);
+    __m256d mins = _mm256_set1_pd(INFINITY);
+    __m256d maxes = _mm256_set1_pd(-INFINITY);
+    for (; i + 4 <= shape.size; i += 4) {
+      __m256d lo = _mm256_loadu_pd(coords + 2 * i);
+      __m256d hi = _mm256_loadu_pd(coords + 2 * i + 4);
+      __m256d xs = _mm256_unpacklo_pd(lo, hi);
+      __m256d ys = _mm256_unpackhi_pd(lo, hi);
+      __m256d dots = _mm256_add_pd(_mm256_mul_pd(xs, axis_x),
+                                   _mm256_mul_pd(ys, axis_y));
+      mins = _mm256_min_pd(mins, dots);
+      maxes = _mm256_max_pd(maxes, dots);
+    }
+    double lanes_min[4];
+    double lanes_max[4];
+    _mm256_storeu_pd(lanes_min, mins);
+    _mm256_storeu_pd(lanes_max, maxes);
+    for (size_t lane = 0; lane < 4; lane++) {
+      dot_min = lanes_min[lane] < dot_min ? lanes_min[lane] : dot_min;
+      dot_max = lanes_max[lane] > dot_max ? lanes_max[lane] : dot_max;
     }
   }
-  return dot_max;
+#elif defined(__SSE2__)
+  // two vertices per step: (x0 y0), (x1 y1) -> two dots
+  if (shape.size >= 2) {
+    __m128d axis_x = _mm_set1_pd(axis.x);
+    __m128d axis_y = _mm_set1_pd(axis.y);
+    __m128d mins = _mm_set1_pd(INFINITY);
+    __m128d maxes = _mm_set1_pd(-INFINITY);
+    for (; i + 2 <= shape.size; i += 2) {
+      __m128d v0 = _mm_loadu_pd(coords + 2 * i);
+      __m128d v1 = _mm_loadu_pd(coords + 2 * i + 2);
+      __m128d xs = _mm_unpacklo_pd(v0, v1);
+      __m128d ys = _mm_unpackhi_pd(v0, v1);
+      __m128d dots =
+          _mm_add_pd(_mm_mul_pd(xs, axis_x), _mm_mul_pd(ys, axis_y));
+      mins = _mm_min_pd(mins, dots);
+      maxes = _mm_max_pd(maxes, dots);
+    }
+    double lanes_min[2];
+    double lanes_max[2];
+    _mm_storeu_pd(lanes_min, mins);
+    _mm_storeu_pd(lanes_max, maxes);
+    for (size_t lane = 0; lane < 2; lane++) {
+      dot_min = lanes_min[lane] < dot_min ? lanes_min[lane] : dot_min;
+      dot_max = lanes_max[lane] > dot_max ? lanes_max[lane] : dot_max;
+    }
+  }
+#endif
+
+  // scalar fallback, and the vertices left over from the SIMD loop
+  for (; i < shape.size; i++) {
+    double dot = coords[2 * i] * axis.x + coords[2 * i + 1] * axis.y;
+    dot_min = dot < dot_min ? dot : dot_min;
+    dot_max = dot > dot_max ? dot : dot_max;
+  }
+  *min = dot_min;
+  *max = dot_max;
 }
 
 // returns the amount of overlap between projections
@@ -101,26 +167,34 @@ double get_overlap(double min1, double max1, double min2, double max2) {
   return -1.0;
 }
 
-// returns separation axis where projections have least overlap
-vector_t check_projections(list_t *shape1, list_t *shape2) {
+// as check_projections(), with shape1 moved by offset1. Moving a shape
+// shifts its projections along each axis without changing its edges' axes,
+// so the shape's vertices are never copied to move it
+static vector_t check_shifted_projections(vertices_t shape1,
+                                          vector_t offset1,
+                                          vertices_t shape2) {
   // initialize
   double least_overlap = INFINITY;
   vector_t collision_axis = {.x = 0.0, .y = 0.0};
 
   // loop through shape1 edges
-  for (size_t i = 0; i < list_size(shape1); i++) {
-    vector_t v1 = *((vector_t *)list_get(shape1, i % list_size(shape1)));
-    vector_t v2 = *((vector_t *)list_get(shape1, (i + 1) % list_size(shape1)));
-    vector_t axis = find_separation_axis(v1, v2);
-
-    double min1 = find_projection_min(shape1, axis);
-    double max1 = find_projection_max(shape1, axis);
-    double min2 = find_projection_min(shape2, axis);
-    double max2 = find_projection_max(shape2, axis);
+  for (size_t i = 0; i < shape1.size; i++) {
+    STATS_ADD(STAT_SAT_AXES, 1);
+    vector_t axis = get_edge_axis(shape1, i);
+
+    double min1, max1, min2, max2;
+    find_projection_bounds(shape1, axis, &min1, &max1);
+    find_projection_bounds(shape2, axis, &min2, &max2);
+    double shift = vec_dot(offset1, axis);
+    // a zero-length edge has no axis; its projections stay empty
+    if (!isnan(shift)) {
+      min1 += shift;
+      max1 += shift;
+    }
     double curr_overlap = get_overlap(min1, max1, min2, max2);
 
     // if no overlap, return VEC_ZERO
-    if (curr_overlap == INFINITY) {
+    if (curr_overlap == -1.0) {
       return (vector_t){.x = 0.0, .y = 0.0};
     }
 
@@ -132,15 +206,19 @@ vector_t check_projections(list_t *shape1, list_t *shape2) {
   }
 
   // loop through shape2 edges
-  for (size_t i = 0; i < list_size(shape2); i++) {
-    vector_t v1 = *((vector_t *)list_get(shape2, i % list_size(shape2)));
-    vector_t v2 = *((vector_t *)list_get(shape2, (i + 1) % list_size(shape2)));
-    vector_t axis = find_separation_axis(v1, v2);
-
-    double min1 = find_projection_min(shape2, axis);
-    double max1 = find_projection_max(shape2, axis);
-    double min2 = find_projection_min(shape1, axis);
-    double max2 = find_projection_max(shape1, axis);
+  for (size_t i = 0; i < shape2.size; i++) {
+    STATS_ADD(STAT_SAT_AXES, 1);
+    vector_t axis = get_edge_axis(shape2, i);
+
+    double min1, max1, min2, max2;
+    find_projection_bounds(shape2, axis, &min1, &max1);
+    find_projection_bounds(shape1, axis, &min2, &max2);
+    double shift = vec_dot(offset1, axis);
+    // a zero-length edge has no axis; its projections stay empty
+    if (!isnan(shift)) {
+      min2 += shift;
+      max2 += shift;
+    }
     double curr_overlap = get_overlap(min1, max1, min2, max2);
 
     // if no overlap, return VEC_ZERO
@@ -158,10 +236,19 @@ vector_t check_projections(list_t *shape1, list_t *shape2) {
   return collision_axis;
 }
 
-collision_info_t find_collision(list_t *shape1, list_t *shape2) {
+// returns separation axis where projections have least overlap
+vector_t check_projections(vertices_t shape1, vertices_t shape2) {
+  return check_shifted_projections(shape1, VEC_ZERO, shape2);
+}
+
+// runs SAT over both shapes' edges, with shape1 moved by offset1
+static collision_info_t find_sat_collision(vertices_t shape1, vector_t offset1,
+                                           vertices_t shape2) {
   collision_info_t info;
-  vector_t overlap = check_projections(shape1, shape2);
-  if (overlap.x == 0.0 || overlap.y == 0.0) {
+  vector_t overlap = check_shifted_projections(shape1, offset1, shape2);
+  // a separated pair gives VEC_ZERO. Exact normals of axis-aligned edges
+  // have a zero component, so only both being zero means no collision.
+  if (overlap.x == 0.0 && overlap.y == 0.0) {
     info.collided = 0;
   } else {
     info.collided = 1;
@@ -169,3 +256,260 @@ collision_info_t find_collision(list_t *shape1, list_t *shape2) {
   info.axis = overlap;
   return info;
 }
+
+// counts a narrow phase test and passes its result through
+static collision_info_t count_collision(collision_info_t info) {
+  STATS_ADD(STAT_COLLISION_TESTS, 1);
+  STATS_ADD(STAT_COLLISION_HITS, info.collided ? 1 : 0);
+  return info;
+}
+
+static collision_info_t find_collision_uncounted(vertices_t shape1,
+                                                 vertices_t shape2) {
+  // bounds take one pass over each shape, while SAT takes one per edge
+  if (!aabb_overlap(vertices_bounds(shape1), vertices_bounds(shape2))) {
+    return (collision_info_t){.collided = false, .axis = VEC_ZERO};
+  }
+  return find_sat_collision(shape1, VEC_ZERO, shape2);
+}
+
+collision_info_t find_collision(vertices_t shape1, vertices_t shape2) {
+  TRACE_BEGIN(zone, "find_collision");
+  collision_info_t info =
+      count_collision(find_collision_uncounted(shape1, shape2));
+  TRACE_END(zone);
+  return info;
+}
+
+collision_info_t find_circle_collision(vector_t center1, double radius1,
+                                       vector_t center2, double radius2) {
+  collision_info_t info = {.collided = false, .axis = VEC_ZERO};
+  vector_t offset = vec_subtract(center2, center1);
+  double dist_squared = vec_dot(offset, offset);
+  double reach = radius1 + radius2;
+  if (dist_squared > reach * reach) {
+    return info;
+  }
+  info.collided = true;
+  // concentric circles have no preferred direction, so any unit axis works
+  double dist = sqrt(dist_squared);
+  info.axis = dist > 0.0 ? vec_multiply(1 / dist, offset)
+                         : (vector_t){.x = 1.0, .y = 0.0};
+  return info;
+}
+
+// measures the overlap of a circle and a polygon projected onto an axis,
+// flipping the axis if needed so it points from the circle to the polygon
+static double circle_polygon_overlap(vector_t center, double radius,
+                                     vertices_t shape, vector_t *axis) {
+  double min, max;
+  find_projection_bounds(shape, *axis, &min, &max);
+  double middle = vec_dot(center, *axis);
+  if (min + max < 2 * middle) {
+    *axis = vec_negate(*axis);
+    double old_min = min;
+    min = -max;
+    max = -old_min;
+    middle = -middle;
+  }
+  return fmin(middle + radius, max) - fmax(middle - radius, min);
+}
+
+collision_info_t find_circle_polygon_collision(vector_t center, double radius,
+                                               vertices_t shape) {
+  collision_info_t info = {.collided = false, .axis = VEC_ZERO};
+  double least_overlap = INFINITY;
+  vector_t closest = shape.data[0];
+  double closest_dist_squared = INFINITY;
+
+  for (size_t i = 0; i < shape.size; i++) {
+    vector_t axis = get_edge_axis(shape, i);
+    double overlap = circle_polygon_overlap(center, radius, shape, &axis);
+    if (overlap < 0.0) {
+      return info;
+    }
+    if (overlap < least_overlap) {
+      least_overlap = overlap;
+      info.axis = axis;
+    }
+    vector_t offset = vec_subtract(shape.data[i], center);
+    double dist_squared = vec_dot(offset, offset);
+    if (dist_squared < closest_dist_squared) {
+      closest_dist_squared = dist_squared;
+      closest = shape.data[i];
+    }
+  }
+
+  // the edge normals miss a circle sitting off a corner
+  if (closest_dist_squared > 0.0) {
+    vector_t axis = vec_multiply(1 / sqrt(closest_dist_squared),
+                                 vec_subtract(closest, center));
+    double overlap = circle_polygon_overlap(center, radius, shape, &axis);
+    if (overlap < 0.0) {
+      return info;
+    }
+    if (overlap < least_overlap) {
+      info.axis = axis;
+    }
+  }
+  info.collided = true;
+  return info;
+}
+
+collision_info_t find_box_collision(aabb_t bounds1, aabb_t bounds2) {
+  collision_info_t info = {.collided = false, .axis = VEC_ZERO};
+  double overlap_x =
+      fmin(bounds1.max.x, bounds2.max.x) - fmax(bounds1.min.x, bounds2.min.x);
+  double overlap_y =
+      fmin(bounds1.max.y, bounds2.max.y) - fmax(bounds1.min.y, bounds2.min.y);
+  if (overlap_x < 0.0 || overlap_y < 0.0) {
+    return info;
+  }
+  info.collided = true;
+  // compares doubled centers to avoid dividing by two
+  if (overlap_x < overlap_y) {
+    double gap = bounds2.min.x + bounds2.max.x - bounds1.min.x - bounds1.max.x;
+    info.axis = (vector_t){.x = gap < 0.0 ? -1.0 : 1.0, .y = 0.0};
+  } else {
+    double gap = bounds2.min.y + bounds2.max.y - bounds1.min.y - bounds1.max.y;
+    info.axis = (vector_t){.x = 0.0, .y = gap < 0.0 ? -1.0 : 1.0};
+  }
+  return info;
+}
+
+// the body's bounds moved by an offset
+static aabb_t shifted_bounds(body_t *body, vector_t offset) {
+  aabb_t bounds = body_get_bounds(body);
+  return (aabb_t){.min = vec_add(bounds.min, offset),
+                  .max = vec_add(bounds.max, offset)};
+}
+
+// tests body1, moved by an offset, against body2. Moving a circle or a box
+// only moves its center or bounds, and any other shape only moves its
+// projections, so nothing is copied
+static collision_info_t find_shifted_collision(body_t *body1, vector_t offset,
+                                               body_t *body2) {
+  // rejects distant pairs with the cached bounds before any shape test
+  if (!aabb_overlap(shifted_bounds(body1, offset), body_get_bounds(body2))) {
+    return (collision_info_t){.collided = false, .axis = VEC_ZERO};
+  }
+  vector_t center1 = vec_add(body_get_centroid(body1), offset);
+  vector_t center2 = body_get_centroid(body2);
+  vector_t between = vec_subtract(center2, center1);
+  double reach =
+      body_get_bounding_radius(body1) + body_get_bounding_radius(body2);
+  if (vec_dot(between, between) > reach * reach) {
+    return (collision_info_t){.collided = false, .axis = VEC_ZERO};
+  }
+
+  shape_kind_t kind1 = body_get_shape_kind(body1);
+  shape_kind_t kind2 = body_get_shape_kind(body2);
+  if (kind1 == SHAPE_CIRCLE && kind2 == SHAPE_CIRCLE) {
+    return find_circle_collision(center1, body_get_radius(body1), center2,
+                                 body_get_radius(body2));
+  }
+  if (kind1 == SHAPE_CIRCLE) {
+    return find_circle_polygon_collision(center1, body_get_radius(body1),
+                                         body_get_vertices(body2));
+  }
+  if (kind2 == SHAPE_CIRCLE) {
+    // moves the circle the other way instead of moving body1's vertices.
+    // The axis is found from the circle's side, so it is flipped back
+    collision_info_t info = find_circle_polygon_collision(
+        vec_subtract(center2, offset), body_get_radius(body2),
+        body_get_vertices(body1));
+    info.axis = vec_negate(info.axis);
+    return info;
+  }
+  if (kind1 == SHAPE_BOX && kind2 == SHAPE_BOX) {
+    return find_box_collision(shifted_bounds(body1, offset),
+                              body_get_bounds(body2));
+  }
+  return find_sat_collision(body_get_vertices(body1), offset,
+                            body_get_vertices(body2));
+}
+
+static collision_info_t find_body_collision_uncounted(body_t *body1,
+                                                      body_t *body2) {
+  return find_shifted_collision(body1, VEC_ZERO, body2);
+}
+
+collision_info_t find_body_collision(body_t *body1, body_t *body2) {
+  TRACE_BEGIN(zone, "find_body_collision");
+  collision_info_t info =
+      count_collision(find_body_collision_uncounted(body1, body2));
+  TRACE_END(zone);
+  return info;
+}
+
+// how far a body reaches along a unit direction, from one side to the other
+static double body_thickness(body_t *body, vector_t direction) {
+  if (body_get_shape_kind(body) == SHAPE_CIRCLE) {
+    return 2 * body_get_radius(body);
+  }
+  double min, max;
+  find_projection_bounds(body_get_vertices(body), direction, &min, &max);
+  return max - min;
+}
+
+double find_time_of_impact(body_t *body1, vector_t start, vector_t end,
+                           body_t *body2) {
+  TRACE_BEGIN(zone, "find_time_of_impact");
+  vector_t motion = vec_subtract(end, start);
+  vector_t from = vec_subtract(start, body_get_centroid(body1));
+  double length = sqrt(vec_dot(motion, motion));
+  // bodies the whole sweep's bounds miss cannot be touched along the way
+  aabb_t swept = shifted_bounds(body1, from);
+  aabb_t last = shifted_bounds(body1, vec_add(from, motion));
+  swept = (aabb_t){.min = {.x = fmin(swept.min.x, last.min.x),
+                           .y = fmin(swept.min.y, last.min.y)},
+                   .max = {.x = fmax(swept.max.x, last.max.x),
+                           .y = fmax(swept.max.y, last.max.y)}};
+  if (!aabb_overlap(swept, body_get_bounds(body2))) {
+    TRACE_END(zone);
+    return INFINITY;
+  }
+
+  // steps of half the thinner body's thickness along the motion cannot
+  // jump over either body, except by clipping a corner
+  size_t steps = 1;
+  if (length > 0.0) {
+    vector_t direction = vec_multiply(1 / length, motion);
+    double thickness = fmin(body_thickness(body1, direction),
+                            body_thickness(body2, direction));
+    double needed = ceil(2 * length / thickness);
+    steps = needed < TOI_MAX_STEPS ? (size_t)needed : TOI_MAX_STEPS;
+    steps = steps > 0 ? steps : 1;
+  }
+
+  double time = INFINITY;
+  double before = 0.0;
+  for (size_t i = 0; i <= steps && time == INFINITY; i++) {
+    double after = (double)i / steps;
+    vector_t offset = vec_add(from, vec_multiply(after, motion));
+    if (!count_collision(find_shifted_collision(body1, offset, body2))
+             .collided) {
+      before = after;
+      continue;
+    }
+    // narrows down the first touch between the last two samples
+    for (size_t j = 0; j < TOI_BISECTIONS && i > 0; j++) {
+      double middle = (before + after) / 2;
+      offset = vec_add(from, vec_multiply(middle, motion));
+      if (count_collision(find_shifted_collision(body1, offset, body2))
+              .collided) {
+        after = middle;
+      } else {
+        before = middle;
+      }
+    }
+    time = after;
+  }
+  TRACE_END(zone);
+  return time;
+}
+
+bool aabb_overlap(aabb_t bounds1, aabb_t bounds2) {
+  return bounds1.min.x <= bounds2.max.x && bounds2.min.x <= bounds1.max.x &&
+         bounds1.min.y <= bounds2.max.y && bounds2.min.y <= bounds1.max.y;
+}
@@ -1,7 +1,9 @@
 #ifndef __COLLISION_H__
 #define __COLLISION_H__
 
+#include "body.h"
 #include "list.h"
+#include "polygon.h"
 #include "vector.h"
 #include <stdbool.h>
 
@@ -23,24 +25,114 @@ typedef struct {
 
 /*
 vector_t find_separation_axis(vector_t v1, vector_t v2);
-double find_projection_min(list_t *shape, vector_t axis);
-double find_projection_max(list_t *shape, vector_t axis);
 double get_overlap(double min1, double max1, double min2, double max2);
-list_t *get_separation_axes(list_t *shape1, list_t *shape2);
-vector_t check_projections(list_t *shape1, list_t *shape2);
+vector_t check_projections(vertices_t shape1, vertices_t shape2);
 */
 
+/**
+ * Finds the smallest and largest projections of a shape's vertices onto
+ * an axis, several vertices at a time where SIMD is available.
+ *
+ * @param shape the shape to project
+ * @param axis the axis to project onto
+ * @param min where to store the smallest projection
+ * @param max where to store the largest projection
+ */
+void find_projection_bounds(vertices_t shape, vector_t axis, double *min,
+                            double *max);
+
 /**
  * Computes the status of the collision between two convex polygons.
- * The shapes are given as lists of vertices in counterclockwise order.
+ * The shapes are given as packed vertex arrays in counterclockwise order.
  * There is an edge between each pair of consecutive vertices,
  * and one between the first vertex and the last vertex.
+ * Shapes whose bounding boxes do not overlap are rejected
+ * before any projections are computed.
  *
  * @param shape1 the first shape
  * @param shape2 the second shape
  * @return whether the shapes are colliding, and if so, the collision axis.
  * The axis should be a unit vector pointing from shape1 towards shape2.
  */
-collision_info_t find_collision(list_t *shape1, list_t *shape2);
+collision_info_t find_collision(vertices_t shape1, vertices_t shape2);
+
+/**
+ * Computes the status of the collision between two circles.
+ *
+ * @param center1 the center of the first circle
+ * @param radius1 the radius of the first circle
+ * @param center2 the center of the second circle
+ * @param radius2 the radius of the second circle
+ * @return whether the circles are colliding, and if so, the unit vector
+ *   from the first center towards the second
+ */
+collision_info_t find_circle_collision(vector_t center1, double radius1,
+                                       vector_t center2, double radius2);
+
+/**
+ * Computes the status of the collision between a circle and a convex polygon.
+ * Tests the polygon's edge normals and the axis from the circle's center
+ * to the nearest vertex, which together separate any disjoint pair.
+ *
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @param shape the polygon, in counterclockwise order
+ * @return whether the shapes are colliding, and if so, the collision axis,
+ *   pointing from the circle towards the polygon
+ */
+collision_info_t find_circle_polygon_collision(vector_t center, double radius,
+                                               vertices_t shape);
+
+/**
+ * Computes the status of the collision between two axis-aligned boxes.
+ * The collision axis is whichever of x or y the boxes overlap least along.
+ *
+ * @param bounds1 the first box
+ * @param bounds2 the second box
+ * @return whether the boxes are colliding, and if so, the collision axis,
+ *   pointing from the first box towards the second
+ */
+collision_info_t find_box_collision(aabb_t bounds1, aabb_t bounds2);
+
+/**
+ * Computes the status of the collision between two bodies,
+ * using the test that fits their shape kinds.
+ * Falls back to find_collision() when either body is a general polygon.
+ * Bodies whose cached bounding boxes or bounding circles do not overlap
+ * are rejected first, without touching their vertices.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return whether the bodies are colliding, and if so, the collision axis
+ */
+collision_info_t find_body_collision(body_t *body1, body_t *body2);
+
+/**
+ * Sweeps a body's shape in a straight line, without turning it, and finds
+ * when it first touches another body that stays where it is.
+ * The sweep is sampled in steps short enough not to jump over either body,
+ * up to a fixed number of them, and the first touch is then narrowed down
+ * by bisection. A sweep that only clips a corner may be missed.
+ *
+ * @param body1 the body to sweep; it is not moved
+ * @param start where body1's centroid starts the sweep
+ * @param end where body1's centroid ends the sweep
+ * @param body2 the body to sweep against
+ * @return the fraction of the way from start to end at which the bodies
+ *   first touch, just past the touch itself: 0 if they already touch at
+ *   start, or INFINITY if they never touch
+ */
+double find_time_of_impact(body_t *body1, vector_t start, vector_t end,
+                           body_t *body2);
+
+/**
+ * Checks whether two axis-aligned bounding boxes overlap.
+ * Boxes that only touch along an edge count as overlapping.
+ *
+ * @param bounds1 the first box
+ * @param bounds2 the second box
+ * @return whether the boxes share any point
+ */
+bool aabb_overlap(aabb_t bounds1, aabb_t bounds2);
 
 #endif // #ifndef __COLLISION_H__
@@ -120,8 +120,7 @@ void emscripten_main(state_t *state) {
   scene_tick(state->circle_list, dt);
   if (!sdl_is_done(state)) {
     for (size_t i = 0; i < scene_bodies(state->circle_list); i++) {
-      sdl_draw_polygon(body_get_vertices(scene_get_body(state->circle_list, i)),
-                       body_get_color(scene_get_body(state->circle_list, i)));
+      sdl_draw_body(scene_get_body(state->circle_list, i));
     }
     sdl_show();
   }
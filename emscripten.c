@@ -1,23 +1,92 @@
 #include "math.h"
 #include "sdl_wrapper.h"
 #include "state.h"
+#include "stats.h"
+#include "trace.h"
 #include <stdio.h>
 #include <stdlib.h>
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
 #endif
 
+// Physics runs at a fixed rate, independent of the frame rate: each frame,
+// emscripten_main() is called once per PHYSICS_HZ step that has elapsed,
+// with time_since_last_tick() returning the step size, and only the last
+// call draws. Bodies are drawn partway between their last two steps to
+// cover the time left over. At most MAX_SUBSTEPS steps run per frame, so a
+// long stall slows the simulation down instead of snowballing.
+// Build with -DPHYSICS_HZ=0 to tick once per frame with the measured dt.
+#ifndef PHYSICS_HZ
+#define PHYSICS_HZ 120
+#endif
+#ifndef MAX_SUBSTEPS
+#define MAX_SUBSTEPS 8
+#endif
+// Build with -DSTATS=1 to count the work done each frame (see stats.h);
+// the counts go to stderr as CSV every STATS_DUMP_EVERY frames,
+// or as JSON lines with -DSTATS_JSON=1.
+// Build with -DTRACE=1 to time each frame and the engine's hot paths
+// (see trace.h); the last zones are written to TRACE_FILE on exit.
+// Build with -DRECORD_INPUT='"session.rec"' to record the session's input,
+// e.g. to reproduce a slowdown; see replay.c to play it back.
+
 state_t *state;
+// time elapsed that has not yet been simulated, in seconds
+double accumulator = 0.0;
+
+void step_frame() {
+  if (PHYSICS_HZ <= 0) {
+    emscripten_main(state);
+    return;
+  }
+
+  double step = 1.0 / PHYSICS_HZ;
+  accumulator += time_since_last_tick();
+  accumulator = fmin(accumulator, MAX_SUBSTEPS * step);
+  size_t steps = (size_t)(accumulator / step);
+  accumulator -= steps * step;
+  if (steps == 0) {
+    // nothing new to draw yet, so the last frame stays on screen while
+    // waiting for the next step instead of spinning
+    sdl_wait(step - accumulator);
+    return;
+  }
+
+  sdl_set_fixed_dt(step);
+  sdl_set_rendering(false);
+  for (size_t i = 1; i < steps; i++) {
+    emscripten_main(state);
+  }
+  sdl_set_rendering(true);
+  sdl_set_interpolation(fmin(accumulator / step, 1.0));
+  emscripten_main(state);
+  sdl_set_fixed_dt(0.0);
+}
 
 void loop() {
   // If needed, generate a pointer to our initial state
   if (!state) {
+#ifdef RECORD_INPUT
+    sdl_record_input(RECORD_INPUT);
+#endif
+#if STATS
+    stats_dump(stderr, STATS_DUMP_EVERY,
+               STATS_JSON ? STATS_FORMAT_JSON : STATS_FORMAT_CSV);
+#endif
     state = emscripten_init();
   }
 
-  emscripten_main(state);
+  TRACE_BEGIN(frame_zone, "frame");
+  step_frame();
+  TRACE_END(frame_zone);
+#if STATS
+  stats_end_frame();
+#endif
 
   if (sdl_is_done(state)) { // Once our demo exits...
+#if TRACE
+    trace_export(TRACE_FILE);
+#endif
     emscripten_free(state); // Free any state variables we've been using
 #ifdef __EMSCRIPTEN__ // Clean up emscripten environment (if we're using it)
     emscripten_cancel_main_loop();
@@ -1,13 +1,24 @@
 #include "forces.h"
 #include "body.h"
 #include "list.h"
+#include "pool.h"
+#include "quadtree.h"
 #include "scene.h"
+#include "threadpool.h"
 #include "vector.h"
 #include <assert.h>
+#include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+// bodies closer than this do not pull on each other in a gravity field
+const double FIELD_MIN_DIST = 5.0;
+// the fewest bodies whose pulls are worth handing to another thread, and
+// how many pieces to split the pulls into per thread
+const size_t FIELD_CHUNK_SIZE = 64;
+const size_t FIELD_CHUNKS_PER_THREAD = 4;
+
 // initializes structs
 typedef struct aux1 {
   body_t *body1;
@@ -25,6 +36,21 @@ typedef struct aux_collide {
   body_t *body2;
 } aux_collide_t;
 
+typedef struct aux_field {
+  scene_t *scene;
+  double constant;
+  double theta;
+  quadtree_t *tree;
+  // scratch arrays reused every tick, sized to the largest scene seen
+  vector_t *positions;
+  double *masses;
+  vector_t *pulls;
+  size_t capacity;
+  // the bodies and pieces of the tick in progress
+  size_t count;
+  size_t chunks;
+} aux_field_t;
+
 body_t *aux_generic_get_body1(aux_generic_t *aux) { return aux->body1; }
 
 body_t *aux_generic_get_body2(aux_generic_t *aux) { return aux->body2; }
@@ -55,17 +81,26 @@ bool aux_generic_get_flagged(aux_generic_t *aux) { return aux->flagged; }
 
 void aux_generic_set_flagged(aux_generic_t *aux) { aux->flagged = true; }
 
-void aux1_free(void *aux1) { free(aux1); }
+void aux1_free(void *aux1) { pool_free(aux1); }
 
-void aux2_free(void *aux2) { free(aux2); }
+void aux2_free(void *aux2) { pool_free(aux2); }
 
-void aux_collide_free(void *aux) { free(aux); }
+void aux_collide_free(void *aux) { pool_free(aux); }
+
+void aux_field_free(void *aux) {
+  aux_field_t *field = aux;
+  quadtree_free(field->tree);
+  free(field->positions);
+  free(field->masses);
+  free(field->pulls);
+  pool_free(field);
+}
 
 void aux_generic_free(void *gen_aux) {
   if (((aux_generic_t *)gen_aux)->aux_freer != NULL) {
     ((aux_generic_t *)gen_aux)->aux_freer(((aux_generic_t *)gen_aux)->aux);
   }
-  free(gen_aux);
+  pool_free(gen_aux);
 }
 
 // turns parameters into an auxiliary type and adds force creator to scene
@@ -74,7 +109,7 @@ void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
   list_t *bodies = list_init(2, (void *)body_free);
   list_add(bodies, body1);
   list_add(bodies, body2);
-  aux2_t *curr_aux = malloc(sizeof(aux2_t));
+  aux2_t *curr_aux = scene_alloc_aux(scene, sizeof(aux2_t));
   curr_aux->body1 = body1;
   curr_aux->body2 = body2;
   curr_aux->constant = G;
@@ -82,11 +117,85 @@ void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                                  curr_aux, bodies, aux2_free);
 }
 
+// finds the pull on one piece of a gravity field's bodies; pieces only read
+// the tree and write their own bodies' slots, so they can run at once
+static void field_chunk_job(void *aux, size_t chunk) {
+  aux_field_t *field = aux;
+  size_t end = (chunk + 1) * field->count / field->chunks;
+  for (size_t i = chunk * field->count / field->chunks; i < end; i++) {
+    field->pulls[i] = quadtree_field(field->tree, field->positions[i],
+                                     field->theta, FIELD_MIN_DIST);
+  }
+}
+
+void gravity_field_creator(void *aux) {
+  aux_field_t *field = aux;
+  size_t count = scene_bodies(field->scene);
+  if (count > field->capacity) {
+    field->capacity = count;
+    field->positions =
+        realloc(field->positions, sizeof(vector_t) * field->capacity);
+    field->masses = realloc(field->masses, sizeof(double) * field->capacity);
+    field->pulls = realloc(field->pulls, sizeof(vector_t) * field->capacity);
+    assert(field->positions != NULL);
+    assert(field->masses != NULL);
+    assert(field->pulls != NULL);
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = scene_get_body(field->scene, i);
+    field->positions[i] = body_get_centroid(body);
+    field->masses[i] = body_get_mass(body);
+  }
+  quadtree_build(field->tree, field->positions, field->masses, count);
+
+  // walking the tree for every body is most of the work, so it is split
+  // across the scene's threads; a pool already busy with the scene's other
+  // forces runs the pieces here instead
+  thread_pool_t *threads = scene_get_thread_pool(field->scene);
+  field->count = count;
+  field->chunks = count / FIELD_CHUNK_SIZE;
+  if (threads == NULL || field->chunks <= 1) {
+    field->chunks = 1;
+    field_chunk_job(field, 0);
+  } else {
+    size_t max_chunks = thread_pool_threads(threads) * FIELD_CHUNKS_PER_THREAD;
+    if (field->chunks > max_chunks) {
+      field->chunks = max_chunks;
+    }
+    thread_pool_run(threads, field_chunk_job, field, field->chunks);
+  }
+
+  // forces are added in body order, as if the pulls were found one by one
+  for (size_t i = 0; i < count; i++) {
+    body_t *body = scene_get_body(field->scene, i);
+    double mass = field->masses[i];
+    if (!isfinite(mass) || body_get_grav(body)) {
+      continue;
+    }
+    body_add_force(body, vec_multiply(field->constant * mass, field->pulls[i]));
+  }
+}
+
+void create_gravity_field(scene_t *scene, double G, double theta) {
+  aux_field_t *curr_aux = scene_alloc_aux(scene, sizeof(aux_field_t));
+  curr_aux->scene = scene;
+  curr_aux->constant = G;
+  curr_aux->theta = theta;
+  curr_aux->tree = quadtree_init();
+  curr_aux->positions = NULL;
+  curr_aux->masses = NULL;
+  curr_aux->pulls = NULL;
+  curr_aux->capacity = 0;
+  scene_add_force_creator(scene, (force_creator_t)gravity_field_creator,
+                          curr_aux, aux_field_free);
+}
+
 void create_normal(scene_t *scene, double k, body_t *body1, body_t *body2) {
   list_t *bodies = list_init(2, (void *)body_free);
   list_add(bodies, body1);
   list_add(bodies, body2);
-  aux2_t *curr_aux = malloc(sizeof(aux2_t));
+  aux2_t *curr_aux = scene_alloc_aux(scene, sizeof(aux2_t));
   curr_aux->body1 = body1;
   curr_aux->body2 = body2;
   curr_aux->constant = k;
@@ -98,7 +207,7 @@ void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2) {
   list_t *bodies = list_init(2, (void *)body_free);
   list_add(bodies, body1);
   list_add(bodies, body2);
-  aux2_t *curr_aux = malloc(sizeof(aux2_t));
+  aux2_t *curr_aux = scene_alloc_aux(scene, sizeof(aux2_t));
   curr_aux->body1 = body1;
   curr_aux->body2 = body2;
   curr_aux->constant = k;
@@ -109,7 +218,7 @@ void create_spring(scene_t *scene, double k, body_t *body1, body_t *body2) {
 void create_drag(scene_t *scene, double gamma, body_t *body) {
   list_t *bodies = list_init(1, (void *)body_free);
   list_add(bodies, body);
-  aux1_t *curr_aux = malloc(sizeof(aux1_t));
+  aux1_t *curr_aux = scene_alloc_aux(scene, sizeof(aux1_t));
   curr_aux->body1 = body;
   curr_aux->constant = gamma;
   scene_add_bodies_force_creator(scene, (force_creator_t)drag_creator, curr_aux,
@@ -118,25 +227,19 @@ void create_drag(scene_t *scene, double gamma, body_t *body) {
 
 void create_destructive_collision(scene_t *scene, body_t *body1,
                                   body_t *body2) {
-  list_t *bodies = list_init(2, (void *)body_free);
-  aux_collide_t *curr_aux = malloc(sizeof(aux_collide_t));
+  aux_collide_t *curr_aux = scene_alloc_aux(scene, sizeof(aux_collide_t));
   curr_aux->body1 = body1;
   curr_aux->body2 = body2;
-  list_add(bodies, body1);
-  list_add(bodies, body2);
   create_collision(scene, body1, body2, (collision_handler_t)collision_creator,
                    curr_aux, aux_collide_free);
 }
 
 void create_half_destructive_collision(scene_t *scene, double elasticity,
                                        body_t *body1, body_t *body2) {
-  list_t *bodies = list_init(2, (void *)body_free);
-  aux2_t *curr_aux = malloc(sizeof(aux2_t));
+  aux2_t *curr_aux = scene_alloc_aux(scene, sizeof(aux2_t));
   curr_aux->body1 = body1;
   curr_aux->body2 = body2;
   curr_aux->constant = elasticity;
-  list_add(bodies, body1);
-  list_add(bodies, body2);
   create_collision(scene, body1, body2,
                    (collision_handler_t)half_destructive_collision_creator,
                    curr_aux, aux2_free);
@@ -144,25 +247,29 @@ void create_half_destructive_collision(scene_t *scene, double elasticity,
 
 void create_physics_collision(scene_t *scene, double elasticity, body_t *body1,
                               body_t *body2) {
-  list_t *bodies = list_init(2, (void *)body_free);
-  aux2_t *curr_aux = malloc(sizeof(aux2_t));
+  aux2_t *curr_aux = scene_alloc_aux(scene, sizeof(aux2_t));
   curr_aux->body1 = body1;
   curr_aux->body2 = body2;
   curr_aux->constant = elasticity;
-  list_add(bodies, body1);
-  list_add(bodies, body2);
   create_collision(scene, body1, body2,
                    (collision_handler_t)physics_collision_creator, curr_aux,
                    aux2_free);
 }
 
-void create_collision(scene_t *scene, body_t *body1, body_t *body2,
-                      collision_handler_t handler, void *aux,
-                      free_func_t freer) {
+// adds a generic collision force, unless an identical one already exists
+static void add_collision(scene_t *scene, body_t *body1, body_t *body2,
+                          collision_handler_t handler, void *aux,
+                          free_func_t freer, bool flagged) {
+  if (scene_has_collision(scene, body1, body2, handler)) {
+    if (freer != NULL) {
+      freer(aux);
+    }
+    return;
+  }
   list_t *bodies = list_init(2, (void *)body_free);
-  aux_generic_t *curr_aux = malloc(sizeof(aux_generic_t));
+  aux_generic_t *curr_aux = scene_alloc_aux(scene, sizeof(aux_generic_t));
   curr_aux->aux = aux;
-  curr_aux->flagged = false;
+  curr_aux->flagged = flagged;
   curr_aux->handler = handler;
   curr_aux->body1 = body1;
   curr_aux->body2 = body2;
@@ -173,3 +280,104 @@ void create_collision(scene_t *scene, body_t *body1, body_t *body2,
                                  (force_creator_t)generic_collision_creator,
                                  curr_aux, bodies, aux_generic_free);
 }
+
+void create_collision(scene_t *scene, body_t *body1, body_t *body2,
+                      collision_handler_t handler, void *aux,
+                      free_func_t freer) {
+  add_collision(scene, body1, body2, handler, aux, freer, false);
+}
+
+force_params_t force_get_params(force_creator_t forcer, void *aux) {
+  force_params_t params = {.kind = FORCE_UNKNOWN,
+                           .body1 = NULL,
+                           .body2 = NULL,
+                           .constant = 0.0,
+                           .theta = 0.0,
+                           .flagged = false};
+  if (forcer == (force_creator_t)gravity_creator) {
+    params.kind = FORCE_NEWTONIAN_GRAVITY;
+  } else if (forcer == (force_creator_t)normal_creator) {
+    params.kind = FORCE_NORMAL;
+  } else if (forcer == (force_creator_t)spring_creator) {
+    params.kind = FORCE_SPRING;
+  }
+  if (params.kind != FORCE_UNKNOWN) {
+    aux2_t *aux2 = aux;
+    params.body1 = aux2->body1;
+    params.body2 = aux2->body2;
+    params.constant = aux2->constant;
+  } else if (forcer == (force_creator_t)drag_creator) {
+    aux1_t *aux1 = aux;
+    params.kind = FORCE_DRAG;
+    params.body1 = aux1->body1;
+    params.constant = aux1->constant;
+  } else if (forcer == (force_creator_t)gravity_field_creator) {
+    aux_field_t *field = aux;
+    params.kind = FORCE_GRAVITY_FIELD;
+    params.constant = field->constant;
+    params.theta = field->theta;
+  } else if (forcer == (force_creator_t)generic_collision_creator) {
+    aux_generic_t *generic = aux;
+    params.body1 = generic->body1;
+    params.body2 = generic->body2;
+    params.flagged = generic->flagged;
+    if (generic->handler == (collision_handler_t)collision_creator) {
+      params.kind = FORCE_DESTRUCTIVE_COLLISION;
+    } else if (generic->handler ==
+               (collision_handler_t)half_destructive_collision_creator) {
+      params.kind = FORCE_HALF_DESTRUCTIVE_COLLISION;
+      params.constant = ((aux2_t *)generic->aux)->constant;
+    } else if (generic->handler ==
+               (collision_handler_t)physics_collision_creator) {
+      params.kind = FORCE_PHYSICS_COLLISION;
+      params.constant = ((aux2_t *)generic->aux)->constant;
+    }
+  }
+  return params;
+}
+
+void create_force_from_params(scene_t *scene, force_params_t params) {
+  switch (params.kind) {
+  case FORCE_NEWTONIAN_GRAVITY:
+    create_newtonian_gravity(scene, params.constant, params.body1,
+                             params.body2);
+    break;
+  case FORCE_GRAVITY_FIELD:
+    create_gravity_field(scene, params.constant, params.theta);
+    break;
+  case FORCE_NORMAL:
+    create_normal(scene, params.constant, params.body1, params.body2);
+    break;
+  case FORCE_SPRING:
+    create_spring(scene, params.constant, params.body1, params.body2);
+    break;
+  case FORCE_DRAG:
+    create_drag(scene, params.constant, params.body1);
+    break;
+  case FORCE_DESTRUCTIVE_COLLISION: {
+    aux_collide_t *curr_aux = scene_alloc_aux(scene, sizeof(aux_collide_t));
+    curr_aux->body1 = params.body1;
+    curr_aux->body2 = params.body2;
+    add_collision(scene, params.body1, params.body2,
+                  (collision_handler_t)collision_creator, curr_aux,
+                  aux_collide_free, params.flagged);
+    break;
+  }
+  case FORCE_HALF_DESTRUCTIVE_COLLISION:
+  case FORCE_PHYSICS_COLLISION: {
+    aux2_t *curr_aux = scene_alloc_aux(scene, sizeof(aux2_t));
+    curr_aux->body1 = params.body1;
+    curr_aux->body2 = params.body2;
+    curr_aux->constant = params.constant;
+    collision_handler_t handler =
+        params.kind == FORCE_PHYSICS_COLLISION
+            ? (collision_handler_t)physics_collision_creator
+            : (collision_handler_t)half_destructive_collision_creator;
+    add_collision(scene, params.body1, params.body2, handler, curr_aux,
+                  aux2_free, params.flagged);
+    break;
+  }
+  default:
+    assert(false);
+  }
+}
@@ -171,6 +171,32 @@ collision_handler_t aux_generic_get_handler(aux_generic_t *aux);
 void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                               body_t *body2);
 
+/**
+ * Adds a force creator to a scene that applies mutual gravity between
+ * all of the scene's bodies, including bodies added later.
+ * Instead of one force creator per pair of bodies, the force creator builds
+ * a Barnes-Hut quadtree over the bodies each tick, which takes
+ * O(n log n) time instead of O(n^2).
+ * Bodies with infinite mass are left out, and no force is applied
+ * to bodies whose gravity has been turned off with body_set_grav().
+ * With a thread pool set (see scene_set_thread_pool()), the pull on each
+ * body is found in parallel, but forces are still added in body order.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param theta the Barnes-Hut opening angle; a cluster of bodies is treated
+ *   as one mass once its size divided by its distance is below theta.
+ *   0 computes every pair exactly, and about 0.5 is a typical tradeoff.
+ */
+void create_gravity_field(scene_t *scene, double G, double theta);
+
+/**
+ * Function to apply the gravity of every body in a scene to every other body
+ *
+ * @param aux an auxiliary struct that contains the scene, G, and theta
+ */
+void gravity_field_creator(void *aux);
+
 void create_normal(scene_t *scene, double k, body_t *body1, body_t *body2);
 /**
  * Adds a force creator to a scene that acts like a spring between two bodies.
@@ -205,6 +231,9 @@ void create_drag(scene_t *scene, double gamma, body_t *body);
  * allowing different things to happen on a collision.
  * The handler is passed the bodies, the collision axis, and an auxiliary value.
  * It should only be called once while the bodies are still colliding.
+ * If the scene already has a collision between body1 and body2 (in that
+ * order) with the same handler, nothing is added and aux is freed,
+ * so this can safely be called every frame.
  *
  * @param scene the scene containing the bodies
  * @param body1 the first body
@@ -259,4 +288,57 @@ void create_half_destructive_collision(scene_t *scene, double elasticity,
 void create_physics_collision(scene_t *scene, double elasticity, body_t *body1,
                               body_t *body2);
 
+/**
+ * The kinds of force that the create_*() functions above add,
+ * as stored in scene snapshots. The values must not change.
+ */
+typedef enum {
+  FORCE_UNKNOWN = 0,
+  FORCE_NEWTONIAN_GRAVITY = 1,
+  FORCE_GRAVITY_FIELD = 2,
+  FORCE_NORMAL = 3,
+  FORCE_SPRING = 4,
+  FORCE_DRAG = 5,
+  FORCE_DESTRUCTIVE_COLLISION = 6,
+  FORCE_HALF_DESTRUCTIVE_COLLISION = 7,
+  FORCE_PHYSICS_COLLISION = 8
+} force_kind_t;
+
+/**
+ * The parameters of a built-in force, enough to add it to a scene again.
+ */
+typedef struct {
+  force_kind_t kind;
+  /** The bodies passed to the create_*() function, or NULL if it has fewer */
+  body_t *body1;
+  body_t *body2;
+  /** G, k, gamma or the elasticity, depending on the kind */
+  double constant;
+  /** The opening angle of a gravity field */
+  double theta;
+  /** Whether a collision was touching at the end of the last tick */
+  bool flagged;
+} force_params_t;
+
+/**
+ * Finds out which built-in force a force creator and aux value make up.
+ *
+ * @param forcer the force creator passed to scene_add_bodies_force_creator()
+ * @param aux the aux value passed with it
+ * @return the force's parameters, with kind FORCE_UNKNOWN if the force
+ *   was not added by one of the create_*() functions above
+ */
+force_params_t force_get_params(force_creator_t forcer, void *aux);
+
+/**
+ * Adds a built-in force to a scene from its parameters,
+ * as if the matching create_*() function had been called.
+ * Asserts that the kind is known.
+ *
+ * @param scene the scene containing the bodies
+ * @param params parameters returned from force_get_params(),
+ *   with the bodies replaced by the scene's bodies
+ */
+void create_force_from_params(scene_t *scene, force_params_t params);
+
 #endif // #ifndef __FORCES_H__
@@ -37,6 +37,8 @@ const double PLAT_HEIGHT = 10;
 const double PLAT_MASS = 60;
 const rgb_color_t PLAT_COLOR = {1.0, 1.0, 1.0};
 const double ACCELERATION = 50.0;
+const char MOON_BOY_SPRITE[] = "assets/moon_boy.png";
+const char STAR_GIRL_SPRITE[] = "assets/star_girl.png";
 
 typedef struct state {
   // make it so that index 0 is grav bar, 1 is stargirl, 2 is moon boy, and rest
@@ -48,59 +50,14 @@ typedef struct state {
 } state_t;
 
 body_t *make_planet(state_t *state, double center_x, double center_y) {
-  list_t *vertices = list_init(4, free);
-  assert(vertices != NULL);
-
-  vector_t *pt1 = malloc(sizeof(vector_t));
-  *pt1 = (vector_t){.x = center_x + (5 / 2), .y = center_y + (5 / 2)};
-  list_add(vertices, pt1);
-
-  vector_t *pt2 = malloc(sizeof(vector_t));
-  *pt2 = (vector_t){.x = center_x - (5 / 2), .y = center_y + (5 / 2)};
-  list_add(vertices, pt2);
-
-  vector_t *pt3 = malloc(sizeof(vector_t));
-  *pt3 = (vector_t){.x = center_x - (5 / 2), .y = center_y - (5 / 2)};
-  list_add(vertices, pt3);
-
-  vector_t *pt4 = malloc(sizeof(vector_t));
-  *pt4 = (vector_t){.x = center_x + (5 / 2), .y = center_y - (5 / 2)};
-  list_add(vertices, pt4);
-
-  body_t *bar =
-      body_init_with_info(vertices, EARTH_MASS, PLAT_COLOR, "bar", NULL);
-  return bar;
+  vector_t center = (vector_t){.x = center_x, .y = center_y};
+  return body_init_box(center, 4, 4, EARTH_MASS, PLAT_COLOR, "bar", NULL);
 }
 
 body_t *make_player(state_t *state, double center_x, double center_y) {
-  // make list & add vertices of rectangle
-  list_t *vertices = list_init(4, free);
-  assert(vertices != NULL);
-
-  vector_t *pt1 = malloc(sizeof(vector_t));
-  *pt1 = (vector_t){.x = center_x + (50 / 2), .y = center_y + (68.5 / 2)};
-  list_add(vertices, pt1);
-
-  vector_t *pt2 = malloc(sizeof(vector_t));
-  *pt2 = (vector_t){.x = center_x - (50 / 2), .y = center_y + (68.5 / 2)};
-  list_add(vertices, pt2);
-
-  vector_t *pt3 = malloc(sizeof(vector_t));
-  *pt3 = (vector_t){.x = center_x - (50 / 2), .y = center_y - (68.5 / 2)};
-  list_add(vertices, pt3);
-
-  vector_t *pt4 = malloc(sizeof(vector_t));
-  *pt4 = (vector_t){.x = center_x + (50 / 2), .y = center_y - (68.5 / 2)};
-  list_add(vertices, pt4);
-
   rgb_color_t color = (rgb_color_t){1.0, 1.0, 1.0};
-
-  body_t *rectangle =
-      body_init_with_prev_grav_info(false, false, vertices, 50, color);
-
-  // add center point to verticies
   vector_t center = (vector_t){.x = center_x, .y = center_y};
-  body_set_centroid(rectangle, center);
+  body_t *rectangle = body_init_box(center, 50, 68.5, 50, color, NULL, NULL);
   vector_t vel = (vector_t){.x = 0, .y = 5};
   vel = vec_negate(vel);
   body_set_velocity(rectangle, vel);
@@ -112,59 +69,14 @@ body_t *make_player(state_t *state, double center_x, double center_y) {
 
 body_t *make_platform(state_t *state, double center_x, double center_y,
                       double length) {
-  list_t *vertices = list_init(4, free);
-  assert(vertices != NULL);
-
-  vector_t *pt1 = malloc(sizeof(vector_t));
-  *pt1 = (vector_t){.x = center_x + (length / 2),
-                    .y = center_y + (PLAT_HEIGHT / 2)};
-  list_add(vertices, pt1);
-
-  vector_t *pt2 = malloc(sizeof(vector_t));
-  *pt2 = (vector_t){.x = center_x - (length / 2),
-                    .y = center_y + (PLAT_HEIGHT / 2)};
-  list_add(vertices, pt2);
-
-  vector_t *pt3 = malloc(sizeof(vector_t));
-  *pt3 = (vector_t){.x = center_x - (length / 2),
-                    .y = center_y - (PLAT_HEIGHT / 2)};
-  list_add(vertices, pt3);
-
-  vector_t *pt4 = malloc(sizeof(vector_t));
-  *pt4 = (vector_t){.x = center_x + (length / 2),
-                    .y = center_y - (PLAT_HEIGHT / 2)};
-  list_add(vertices, pt4);
-
-  body_t *platform = body_init_with_prev_grav_info(false, false, vertices,
-                                                   PLAT_MASS, PLAT_COLOR);
-
-  return platform;
+  vector_t center = (vector_t){.x = center_x, .y = center_y};
+  return body_init_box(center, length, PLAT_HEIGHT, PLAT_MASS, PLAT_COLOR, NULL,
+                       NULL);
 }
 
 body_t *make_trampoline(state_t *state, double center_x, double center_y) {
-  list_t *vertices = list_init(4, free);
-  assert(vertices != NULL);
-
-  vector_t *pt1 = malloc(sizeof(vector_t));
-  *pt1 = (vector_t){.x = center_x + (40 / 2), .y = center_y + (20 / 2)};
-  list_add(vertices, pt1);
-
-  vector_t *pt2 = malloc(sizeof(vector_t));
-  *pt2 = (vector_t){.x = center_x - (40 / 2), .y = center_y + (20 / 2)};
-  list_add(vertices, pt2);
-
-  vector_t *pt3 = malloc(sizeof(vector_t));
-  *pt3 = (vector_t){.x = center_x - (40 / 2), .y = center_y - (20 / 2)};
-  list_add(vertices, pt3);
-
-  vector_t *pt4 = malloc(sizeof(vector_t));
-  *pt4 = (vector_t){.x = center_x + (40 / 2), .y = center_y - (20 / 2)};
-  list_add(vertices, pt4);
-
-  body_t *rectangle = body_init_with_prev_grav_info(false, false, vertices,
-                                                    PLAT_MASS, PLAT_COLOR);
-
-  return rectangle;
+  vector_t center = (vector_t){.x = center_x, .y = center_y};
+  return body_init_box(center, 40, 20, PLAT_MASS, PLAT_COLOR, NULL, NULL);
 }
 
 void hitting_sides(state_t *state, body_t *body_player) {
@@ -258,6 +170,8 @@ state_t *emscripten_init() {
   state->trampoline_list = scene_init();
   state->time = 0.0;
   sdl_init(WINDOW_MIN, WINDOW_MAX);
+  sdl_preload_sprite(MOON_BOY_SPRITE);
+  sdl_preload_sprite(STAR_GIRL_SPRITE);
   scene_add_body(state->trampoline_list, make_trampoline(state, 500, 10));
   scene_add_body(state->grav_player_list,
                  make_planet(state, 500, EARTH_RADIUS));
@@ -267,23 +181,30 @@ state_t *emscripten_init() {
     size_t x = (170 * i) + 140;
     if (i == 0 || i == 4) {
       size_t y = 200;
-      scene_add_body(state->platforms_list, make_platform(state, x, y, 50));
+      scene_add_static_body(state->platforms_list,
+                            make_platform(state, x, y, 50));
     }
     if (i == 1 || i == 3) {
       size_t y_1 = 200 + 70;
       size_t y_2 = 200 - 70;
-      scene_add_body(state->platforms_list, make_platform(state, x, y_1, 50));
-      scene_add_body(state->platforms_list, make_platform(state, x, y_2, 50));
+      scene_add_static_body(state->platforms_list,
+                            make_platform(state, x, y_1, 50));
+      scene_add_static_body(state->platforms_list,
+                            make_platform(state, x, y_2, 50));
     }
     if (i == 2) {
       size_t y_1 = 200 + 70 * 2;
       size_t y_2 = 200 - 70 * 2;
-      scene_add_body(state->platforms_list, make_platform(state, x, y_1, 50));
-      scene_add_body(state->platforms_list, make_platform(state, x, y_2, 50));
+      scene_add_static_body(state->platforms_list,
+                            make_platform(state, x, y_1, 50));
+      scene_add_static_body(state->platforms_list,
+                            make_platform(state, x, y_2, 50));
     }
   }
-  scene_add_body(state->platforms_list, make_platform(state, 50, 440, 200));
-  scene_add_body(state->platforms_list, make_platform(state, 950, 440, 200));
+  scene_add_static_body(state->platforms_list,
+                        make_platform(state, 50, 440, 200));
+  scene_add_static_body(state->platforms_list,
+                        make_platform(state, 950, 440, 200));
 
   sdl_on_key(move_characters);
   return state;
@@ -316,9 +237,7 @@ void check_collision(state_t *state, body_t *body_player, body_t *platform,
                      bool key_up) {
   // make new flag for prev collision, if true and find collision and holding
   // key up, dont reset collision if find collision otherwise reset collision
-  if (find_collision(body_get_vertices(body_player),
-                     body_get_vertices(platform))
-          .collided) {
+  if (find_body_collision(body_player, platform).collided) {
     // if in boundary of platform
     if (body_get_centroid(body_player).x - 18 <
             body_get_centroid(platform).x + PLAT_LENGTH / 2 &&
@@ -387,15 +306,14 @@ void trampoline_collision(state_t *state) {
 void emscripten_main(state_t *state) {
   sdl_clear();
   double dt = time_since_last_tick();
-  bool test;
-  for (size_t i = 0; i < scene_bodies(state->platforms_list); i++) {
+  bool test = true;
+  for (size_t i = 0; i < scene_static_bodies(state->platforms_list); i++) {
     check_collision(state, scene_get_body(state->grav_player_list, 1),
-                    scene_get_body(state->platforms_list, i), up_star);
+                    scene_get_static_body(state->platforms_list, i), up_star);
     check_collision(state, scene_get_body(state->grav_player_list, 2),
-                    scene_get_body(state->platforms_list, i), up_moon);
-    if (find_collision(
-            body_get_vertices(scene_get_body(state->grav_player_list, 1)),
-            body_get_vertices(scene_get_body(state->platforms_list, i)))
+                    scene_get_static_body(state->platforms_list, i), up_moon);
+    if (find_body_collision(scene_get_body(state->grav_player_list, 1),
+                            scene_get_static_body(state->platforms_list, i))
             .collided) {
       test = false;
     }
@@ -413,38 +331,32 @@ void emscripten_main(state_t *state) {
 
   for (size_t i = 0; i < scene_bodies(state->grav_player_list); i++) {
     if (i != 1 && i != 2) {
-      sdl_draw_polygon(
-          body_get_vertices(scene_get_body(state->grav_player_list, i)),
-          body_get_color(scene_get_body(state->grav_player_list, i)));
+      sdl_draw_body(scene_get_body(state->grav_player_list, i));
     }
   }
 
-  scene_tick(state->platforms_list, dt);
-  for (size_t i = 0; i < scene_bodies(state->platforms_list); i++) {
-    sdl_draw_polygon(
-        body_get_vertices(scene_get_body(state->platforms_list, i)),
-        body_get_color(scene_get_body(state->platforms_list, i)));
+  // platforms are static, so there is nothing to tick
+  for (size_t i = 0; i < scene_static_bodies(state->platforms_list); i++) {
+    sdl_draw_body(scene_get_static_body(state->platforms_list, i));
   }
 
   scene_tick(state->trampoline_list, dt);
   for (size_t i = 0; i < scene_bodies(state->trampoline_list); i++) {
-    sdl_draw_polygon(
-        body_get_vertices(scene_get_body(state->trampoline_list, i)),
-        body_get_color(scene_get_body(state->trampoline_list, i)));
+    sdl_draw_body(scene_get_body(state->trampoline_list, i));
   }
 
-  vector_t center_of_sprite =
-      body_get_centroid(scene_get_body(state->grav_player_list, 2));
+  vector_t center_of_sprite = body_get_interpolated_centroid(
+      scene_get_body(state->grav_player_list, 2), sdl_get_interpolation());
   double old_y = center_of_sprite.y;
   center_of_sprite.y = old_y - (2 * (old_y - 250));
-  sdl_draw_sprite("assets/moon_boy.png", center_of_sprite,
+  sdl_draw_sprite(MOON_BOY_SPRITE, center_of_sprite,
                   (vector_t){50.0, 50.0 * 585 / 427});
 
-  vector_t center_of_sprite_star =
-      body_get_centroid(scene_get_body(state->grav_player_list, 1));
+  vector_t center_of_sprite_star = body_get_interpolated_centroid(
+      scene_get_body(state->grav_player_list, 1), sdl_get_interpolation());
   double old_y2 = center_of_sprite_star.y;
   center_of_sprite_star.y = old_y2 - (2 * (old_y2 - 250));
-  sdl_draw_sprite("assets/star_girl.png", center_of_sprite_star,
+  sdl_draw_sprite(STAR_GIRL_SPRITE, center_of_sprite_star,
                   (vector_t){50.0, 50.0 * 585 / 427});
 
   sdl_show();
@@ -454,5 +366,6 @@ void emscripten_free(state_t *state) {
   scene_free(state->grav_player_list);
   scene_free(state->platforms_list);
   scene_free(state->trampoline_list);
+  sdl_evict_all_sprites();
   free(state);
 }
@@ -0,0 +1,142 @@
+// Runs a demo without a window, for benchmarking the physics on machines
+// with no display or GPU. This file replaces both sdl_wrapper.c (with a
+// renderer that draws nothing) and emscripten.c (with a loop that ticks a
+// fixed number of frames at a fixed dt), so it links against any one demo.
+// To build and run nbodies.c (the gcc command is a single line):
+//
+//   gcc -O2 -pthread -o bench headless.c nbodies.c body.c collision.c
+//       forces.c list.c polygon.c pool.c quadtree.c scene.c shape.c
+//       threadpool.c vector.c -lm
+//   ./bench [frames] [dt] [seed]
+//
+// Every call to emscripten_main() is timed, and the run is summarized as
+// ticks per second, median and 99th percentile tick latency, and peak RSS.
+// Demos that seed rand() themselves (e.g. pegs.c) ignore the seed argument.
+// Add -DSCENE_THREADS=0 to split each scene's tick across every core.
+// Add -DSTATS=1 and stats.c to also dump per-frame counters to stderr,
+// and -DTRACE=1 and trace.c to write a trace of the run to TRACE_FILE,
+// as in emscripten.c.
+
+#include "sdl_wrapper.h"
+#include "state.h"
+#include "stats.h"
+#include "trace.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <time.h>
+
+static const size_t DEFAULT_FRAMES = 10000;
+static const double DEFAULT_DT = 1.0 / 60.0;
+static const unsigned DEFAULT_SEED = 0;
+
+// the dt handed to the demo each frame in place of wall-clock time
+static double fixed_dt;
+
+void sdl_init(vector_t min, vector_t max) {}
+
+bool sdl_is_done(state_t *state) { return false; }
+
+void sdl_clear(void) {}
+
+void sdl_draw_polygon(list_t *points, rgb_color_t color) {}
+
+void sdl_draw_vertices(vertices_t points, rgb_color_t color) {}
+
+void sdl_draw_body(body_t *body) {}
+
+void sdl_draw_sprite(const char *im_path, vector_t center, vector_t dim) {}
+
+bool sdl_preload_sprite(const char *im_path) { return true; }
+
+void sdl_evict_sprite(const char *im_path) {}
+
+void sdl_evict_all_sprites(void) {}
+
+void sdl_show(void) {}
+
+void sdl_render_scene(scene_t *scene) {}
+
+void sdl_on_key(key_handler_t handler) {}
+
+double time_since_last_tick(void) { return fixed_dt; }
+
+void sdl_set_fixed_dt(double dt) {}
+
+void sdl_record_input(const char *path) {}
+
+void sdl_set_rendering(bool enabled) {}
+
+void sdl_set_interpolation(double alpha) {}
+
+double sdl_get_interpolation(void) { return 1.0; }
+
+void sdl_wait(double seconds) {}
+
+static double now(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+// nearest-rank percentile of a sorted array
+static double percentile(double *sorted, size_t count, double p) {
+  size_t rank = (size_t)(p * count);
+  return sorted[rank < count ? rank : count - 1];
+}
+
+int main(int argc, char **argv) {
+  size_t frames = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_FRAMES;
+  fixed_dt = argc > 2 ? strtod(argv[2], NULL) : DEFAULT_DT;
+  unsigned seed = argc > 3 ? strtoul(argv[3], NULL, 10) : DEFAULT_SEED;
+  if (frames == 0 || !(fixed_dt > 0.0)) {
+    fprintf(stderr, "usage: %s [frames] [dt] [seed]\n", argv[0]);
+    return 1;
+  }
+
+  double *latencies = malloc(sizeof(double) * frames);
+  assert(latencies != NULL);
+  srand(seed);
+  state_t *state = emscripten_init();
+#if STATS
+  stats_dump(stderr, STATS_DUMP_EVERY,
+             STATS_JSON ? STATS_FORMAT_JSON : STATS_FORMAT_CSV);
+#endif
+
+  double start = now();
+  for (size_t i = 0; i < frames; i++) {
+    double tick_start = now();
+    TRACE_BEGIN(frame_zone, "frame");
+    emscripten_main(state);
+    TRACE_END(frame_zone);
+    latencies[i] = now() - tick_start;
+#if STATS
+    stats_end_frame();
+#endif
+  }
+  double total = now() - start;
+#if TRACE
+  trace_export(TRACE_FILE);
+#endif
+
+  emscripten_free(state);
+  qsort(latencies, frames, sizeof(double), compare_doubles);
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  // one key=value line, easy to scrape from CI logs
+  printf("frames=%zu dt=%g ticks_per_sec=%.1f p50_us=%.2f p99_us=%.2f "
+         "peak_rss_kb=%ld\n",
+         frames, fixed_dt, frames / total,
+         percentile(latencies, frames, 0.50) * 1e6,
+         percentile(latencies, frames, 0.99) * 1e6, usage.ru_maxrss);
+  free(latencies);
+  return 0;
+}
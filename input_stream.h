@@ -0,0 +1,36 @@
+#ifndef __INPUT_STREAM_H__
+#define __INPUT_STREAM_H__
+
+/**
+ * The format of the input recordings written by sdl_record_input() and
+ * played back by replay.c.
+ *
+ * A recording starts with the 8 bytes of INPUT_STREAM_MAGIC and a uint32_t
+ * INPUT_STREAM_VERSION, followed by one record for every time the demo saw
+ * the outside world, in order. Each record is a one-byte input_record_t
+ * followed by its fields, written in the machine's own byte order.
+ * The fixed steps passed to sdl_set_fixed_dt() are not recorded, so a
+ * recording must be replayed with the same PHYSICS_HZ it was recorded with.
+ */
+
+#define INPUT_STREAM_MAGIC "INPUTREC"
+#define INPUT_STREAM_VERSION 1
+/** The size of the keyboard state array passed to key handlers */
+#define INPUT_STREAM_KEYS 512
+
+typedef enum {
+  /** A double: the dt measured by a call to time_since_last_tick() */
+  INPUT_TIME = 1,
+  /**
+   * A key event passed to the key handler: a uint8_t key_event_type_t,
+   * the double held time, a uint16_t count and the uint16_t scancodes of
+   * the count keys that were down
+   */
+  INPUT_KEY = 2,
+  /** The end of a call to sdl_is_done() that returned false */
+  INPUT_POLL = 3,
+  /** The window was closed, ending the recording */
+  INPUT_QUIT = 4
+} input_record_t;
+
+#endif // #ifndef __INPUT_STREAM_H__
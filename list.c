@@ -35,8 +35,11 @@ list_t *list_init(size_t initial_size, free_func_t freer) {
 size_t list_size(list_t *list) { return list->size; }
 
 void list_free(list_t *list) {
-  for (size_t i = 0; i < list->size; i++) {
-    list->freer(list->arr[i]);
+  // a NULL freer means the list does not own its elements
+  if (list->freer != NULL) {
+    for (size_t i = 0; i < list->size; i++) {
+      list->freer(list->arr[i]);
+    }
   }
   free(list->arr);
   free(list);
@@ -66,6 +69,12 @@ void list_add(list_t *list, void *value) {
   list->size++;
 }
 
+void list_set(list_t *list, size_t index, void *value) {
+  assert(index < list->size);
+  assert(value != NULL);
+  list->arr[index] = value;
+}
+
 void *list_remove(list_t *list, size_t index) {
   assert(list->size > 0);
   void *old_value = list->arr[index];
@@ -78,3 +87,11 @@ void *list_remove(list_t *list, size_t index) {
   list->size--;
   return old_value;
 }
+
+void *list_swap_remove(list_t *list, size_t index) {
+  assert(index < list->size);
+  void *old_value = list->arr[index];
+  list->arr[index] = list->arr[list->size - 1];
+  list->size--;
+  return old_value;
+}
@@ -54,6 +54,17 @@ size_t list_size(list_t *list);
  */
 void *list_get(list_t *list, size_t index);
 
+/**
+ * Replaces the element at a given index in a list.
+ * The old element is not freed.
+ * Asserts that the index is valid and that the new element is not NULL.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param index an index in the list (the first element is at 0)
+ * @param value the element to store at the index
+ */
+void list_set(list_t *list, size_t index, void *value);
+
 /**
  * Removes the element at a given index in a list and returns it,
  * moving all subsequent elements towards the start of the list.
@@ -64,6 +75,19 @@ void *list_get(list_t *list, size_t index);
  */
 void *list_remove(list_t *list, size_t index);
 
+/**
+ * Removes the element at a given index in a list and returns it,
+ * moving the last element of the list into its place.
+ * Unlike list_remove(), this takes constant time but changes the order
+ * of the remaining elements.
+ * Asserts that the index is valid, given the list's current size.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param index an index in the list (the first element is at 0)
+ * @return the element at the given index in the list
+ */
+void *list_swap_remove(list_t *list, size_t index);
+
 /**
  * Appends an element to the end of a list.
  * If the list is filled to capacity, resizes the list to fit more elements
@@ -26,6 +26,7 @@ const double NUM_POINTS = 8;
 
 const double MASS_CONSTANT = 20;
 const double G = 100.0;
+const double THETA = 0.5;
 
 // state
 typedef struct state {
@@ -87,14 +88,8 @@ state_t *emscripten_init() {
     scene_add_body(state->body_list,
                    make_four_star(center_x, center_y, mass, radius));
   }
-  // nested for loop to apply forces to each pair of bodies
-  for (size_t i = 0; i < NUM_BODIES; i++) {
-    for (size_t j = i + 1; j < NUM_BODIES; j++) {
-      create_newtonian_gravity(state->body_list, G,
-                               scene_get_body(state->body_list, i),
-                               scene_get_body(state->body_list, j));
-    }
-  }
+  // one force creator applies gravity between every pair of bodies
+  create_gravity_field(state->body_list, G, THETA);
   return state;
 }
 
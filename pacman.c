@@ -221,11 +221,9 @@ void emscripten_main(state_t *state) {
 
   scene_tick(state->pellet_list, dt);
   if (!sdl_is_done(state)) {
-    sdl_draw_polygon(body_get_vertices(scene_get_body(state->pellet_list, 0)),
-                     PACMAN_COLOR);
-    for (size_t i = 1; i < scene_bodies(state->pellet_list); i++) {
-      sdl_draw_polygon(body_get_vertices(scene_get_body(state->pellet_list, i)),
-                       PELLET_COLOR);
+    // drawn in their own colors, between their last two ticks
+    for (size_t i = 0; i < scene_bodies(state->pellet_list); i++) {
+      sdl_draw_body(scene_get_body(state->pellet_list, i));
     }
     sdl_show();
   }
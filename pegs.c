@@ -7,8 +7,6 @@
 #include <stdlib.h>
 #include <time.h>
 
-#define CIRCLE_POINTS 40
-
 #define MAX ((vector_t){.x = 80.0, .y = 80.0})
 
 #define N_ROWS 11
@@ -28,6 +26,7 @@
 #define START_VELOCITY ((vector_t){.x = 0.0, .y = -8.0})
 
 #define BALL_MASS 2.0
+#define GRID_CELL_SIZE (4 * BALL_RADIUS)
 
 #define BALL_COLOR ((rgb_color_t){1, 0, 0})
 #define PEG_COLOR ((rgb_color_t){0, 1, 0})
@@ -78,20 +77,6 @@ list_t *rect_init(double width, double height) {
   return rect;
 }
 
-/** Constructs a circles with the given radius centered at (0, 0) */
-list_t *circle_init(double radius) {
-  list_t *circle = list_init(CIRCLE_POINTS, free);
-  double arc_angle = 2 * M_PI / CIRCLE_POINTS;
-  vector_t point = {.x = radius, .y = 0.0};
-  for (size_t i = 0; i < CIRCLE_POINTS; i++) {
-    vector_t *v = malloc(sizeof(*v));
-    *v = point;
-    list_add(circle, v);
-    point = vec_rotate(point, arc_angle);
-  }
-  return circle;
-}
-
 /** Computes the center of the peg in the given row and column */
 vector_t get_peg_center(size_t row, size_t col) {
   vector_t center = {.x = MAX.x / 2 + (col - row * 0.5) * COL_SPACING,
@@ -102,23 +87,17 @@ vector_t get_peg_center(size_t row, size_t col) {
 /** Creates an Earth-like mass to accelerate the balls */
 void add_gravity_body(scene_t *scene) {
   // Will be offscreen, so shape is irrelevant
-  list_t *gravity_ball = rect_init(1, 1);
-  body_t *body = body_init_with_info(gravity_ball, M, WALL_COLOR,
-                                     make_type_info(GRAVITY), free);
-
   // Move a distnace R below the scene
   vector_t gravity_center = {.x = MAX.x / 2, .y = -R};
-  body_set_centroid(body, gravity_center);
+  body_t *body = body_init_box(gravity_center, 1, 1, M, WALL_COLOR,
+                               make_type_info(GRAVITY), free);
   scene_add_body(scene, body);
 }
 
 /** Creates a ball with the given starting position and velocity */
 body_t *get_ball(vector_t center, vector_t velocity) {
-  list_t *shape = circle_init(BALL_RADIUS);
-  body_t *ball = body_init_with_info(shape, BALL_MASS, BALL_COLOR,
-                                     make_type_info(BALL), free);
-
-  body_set_centroid(ball, center);
+  body_t *ball = body_init_circle(center, BALL_RADIUS, BALL_MASS, BALL_COLOR,
+                                  make_type_info(BALL), free);
   body_set_velocity(ball, velocity);
 
   return ball;
@@ -147,6 +126,27 @@ void freeze(body_t *ball, body_t *target, vector_t axis, void *aux) {
   }
 }
 
+/** Adds the force creators between a new ball and another body */
+void add_ball_forces(scene_t *scene, body_t *ball, body_t *body) {
+  switch (get_type(body)) {
+  case BALL:
+    // Bounce off other balls
+    create_physics_collision(scene, BALL_ELASTICITY, ball, body);
+    break;
+  case WALL:
+    // Bounce off walls and pegs
+    create_physics_collision(scene, PEG_ELASTICITY, ball, body);
+    break;
+  case FROZEN:
+    // Freeze when hitting the ground or frozen balls
+    create_collision(scene, ball, body, freeze, scene, NULL);
+    break;
+  case GRAVITY:
+    // Simulate earth's gravity acting on the ball
+    create_newtonian_gravity(scene, G, body, ball);
+  }
+}
+
 /** Adds a ball to the scene */
 void add_ball(scene_t *scene) {
   // Add the ball to the scene.
@@ -158,24 +158,10 @@ void add_ball(scene_t *scene) {
 
   // Add force creators with other bodies
   for (size_t i = 0; i < body_count; i++) {
-    body_t *body = scene_get_body(scene, i);
-    switch (get_type(body)) {
-    case BALL:
-      // Bounce off other balls
-      create_physics_collision(scene, BALL_ELASTICITY, ball, body);
-      break;
-    case WALL:
-      // Bounce off walls and pegs
-      create_physics_collision(scene, PEG_ELASTICITY, ball, body);
-      break;
-    case FROZEN:
-      // Freeze when hitting the ground or frozen balls
-      create_collision(scene, ball, body, freeze, scene, NULL);
-      break;
-    case GRAVITY:
-      // Simulate earth's gravity acting on the ball
-      create_newtonian_gravity(scene, G, body, ball);
-    }
+    add_ball_forces(scene, ball, scene_get_body(scene, i));
+  }
+  for (size_t i = 0; i < scene_static_bodies(scene); i++) {
+    add_ball_forces(scene, ball, scene_get_static_body(scene, i));
   }
 }
 
@@ -184,11 +170,10 @@ void add_pegs(scene_t *scene) {
   // Add N_ROWS and N_COLS of pegs.
   for (size_t i = 1; i <= N_ROWS; i++) {
     for (size_t j = 0; j <= i; j++) {
-      list_t *polygon = circle_init(PEG_RADIUS);
-      body_t *body = body_init_with_info(polygon, INFINITY, PEG_COLOR,
-                                         make_type_info(WALL), free);
-      body_set_centroid(body, get_peg_center(i, j));
-      scene_add_body(scene, body);
+      body_t *body =
+          body_init_circle(get_peg_center(i, j), PEG_RADIUS, INFINITY,
+                           PEG_COLOR, make_type_info(WALL), free);
+      scene_add_static_body(scene, body);
     }
   }
 }
@@ -201,21 +186,20 @@ void add_walls(scene_t *scene) {
   polygon_rotate(rect, WALL_ANGLE, VEC_ZERO);
   body_t *body = body_init_with_info(rect, INFINITY, WALL_COLOR,
                                      make_type_info(WALL), free);
-  scene_add_body(scene, body);
+  scene_add_static_body(scene, body);
 
   rect = rect_init(WALL_LENGTH, WALL_WIDTH);
   polygon_translate(rect, (vector_t){.x = MAX.x - WALL_LENGTH / 2, .y = 0.0});
   polygon_rotate(rect, -WALL_ANGLE, (vector_t){.x = MAX.x, .y = 0.0});
   body = body_init_with_info(rect, INFINITY, WALL_COLOR, make_type_info(WALL),
                              free);
-  scene_add_body(scene, body);
+  scene_add_static_body(scene, body);
 
   // Ground is special; it freezes balls when they touch it
-  rect = rect_init(MAX.x, WALL_WIDTH);
-  body = body_init_with_info(rect, INFINITY, WALL_COLOR, make_type_info(FROZEN),
-                             free);
-  body_set_centroid(body, (vector_t){.x = MAX.x / 2, .y = WALL_WIDTH / 2});
-  scene_add_body(scene, body);
+  body = body_init_box((vector_t){.x = MAX.x / 2, .y = WALL_WIDTH / 2}, MAX.x,
+                       WALL_WIDTH, INFINITY, WALL_COLOR,
+                       make_type_info(FROZEN), free);
+  scene_add_static_body(scene, body);
 }
 
 typedef struct state {
@@ -228,6 +212,7 @@ state_t *emscripten_init(void) {
   // Initialize scene
   sdl_init(VEC_ZERO, MAX);
   scene_t *scene = scene_init();
+  scene_set_cell_size(scene, GRID_CELL_SIZE);
   // Add elements to the scene
   add_gravity_body(scene);
   add_pegs(scene);
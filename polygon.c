@@ -137,6 +137,74 @@ void polygon_rotate(list_t *polygon, double angle, vector_t point) {
   }
 }
 
+vertices_t vertices_from_list(list_t *polygon) {
+  size_t len = list_size(polygon);
+  vector_t *data = malloc(sizeof(vector_t) * (len > 0 ? len : 1));
+  assert(data != NULL);
+  for (size_t i = 0; i < len; i++) {
+    data[i] = *(vector_t *)list_get(polygon, i);
+  }
+  return (vertices_t){.data = data, .size = len, .normals = NULL};
+}
+
+double vertices_area(vertices_t polygon) {
+  // using shoelace formula
+  double area = 0.0;
+  size_t len = polygon.size;
+  for (size_t i = 0; i < len; i++) {
+    area += vec_cross(polygon.data[i], polygon.data[(i + 1) % len]);
+  }
+  return area / 2.0;
+}
+
+vector_t vertices_centroid(vertices_t polygon) {
+  // using centroid formula for x and y individually
+  double x = 0.0;
+  double y = 0.0;
+  size_t len = polygon.size;
+  for (size_t i = 0; i < len; i++) {
+    vector_t vec_1 = polygon.data[i];
+    vector_t vec_2 = polygon.data[(i + 1) % len];
+    double cross = vec_cross(vec_1, vec_2);
+    x += (vec_1.x + vec_2.x) * cross;
+    y += (vec_1.y + vec_2.y) * cross;
+  }
+
+  double scale = 1 / (6 * vertices_area(polygon));
+  return (vector_t){.x = scale * x, .y = scale * y};
+}
+
+void vertices_translate(vertices_t polygon, vector_t translation) {
+  for (size_t i = 0; i < polygon.size; i++) {
+    polygon.data[i].x += translation.x;
+    polygon.data[i].y += translation.y;
+  }
+}
+
+void vertices_rotate(vertices_t polygon, double angle, vector_t point) {
+  // computes the rotation once instead of per vertex
+  double c = cos(angle);
+  double s = sin(angle);
+  for (size_t i = 0; i < polygon.size; i++) {
+    vector_t sub = vec_subtract(polygon.data[i], point);
+    polygon.data[i] = (vector_t){.x = sub.x * c - sub.y * s + point.x,
+                                 .y = sub.x * s + sub.y * c + point.y};
+  }
+}
+
+aabb_t vertices_bounds(vertices_t polygon) {
+  aabb_t bounds = {.min = {.x = INFINITY, .y = INFINITY},
+                   .max = {.x = -INFINITY, .y = -INFINITY}};
+  for (size_t i = 0; i < polygon.size; i++) {
+    vector_t v = polygon.data[i];
+    bounds.min.x = fmin(bounds.min.x, v.x);
+    bounds.min.y = fmin(bounds.min.y, v.y);
+    bounds.max.x = fmax(bounds.max.x, v.x);
+    bounds.max.y = fmax(bounds.max.y, v.y);
+  }
+  return bounds;
+}
+
 // adjusts position after hitting bottom
 void polygon_hitting_bottom(polygon_t *polygon, list_t *vertices) {
   for (size_t i = 0; i < list_size(vertices); i++) {
@@ -174,3 +242,12 @@ void polygon_free(polygon_t *polygon) {
 }
 
 rgb_color_t polygon_get_color(polygon_t *polygon) { return polygon->color; }
+
+void vertices_edge_normals(vertices_t polygon, vector_t *normals) {
+  for (size_t i = 0; i < polygon.size; i++) {
+    vector_t edge = vec_subtract(polygon.data[i],
+                                 polygon.data[(i + 1) % polygon.size]);
+    double scale = 1 / sqrt(edge.x * edge.x + edge.y * edge.y);
+    normals[i] = (vector_t){.x = -edge.y * scale, .y = edge.x * scale};
+  }
+}
@@ -16,6 +16,31 @@
  */
 typedef struct polygon polygon_t;
 
+/**
+ * A polygon stored as a packed array of vertices.
+ * Unlike a list_t of vector_t*, the vertices sit next to each other in memory,
+ * so walking the polygon does not follow a separate pointer for each vertex.
+ * vertices_t is passed *by value*; it does not own the array it points to.
+ */
+typedef struct {
+  vector_t *data;
+  size_t size;
+  /**
+   * If non-NULL, the unit normal of each edge, from vertex i to vertex i + 1,
+   * kept up to date by the owner of the vertices so that collision tests
+   * do not have to recompute them. See vertices_edge_normals().
+   */
+  vector_t *normals;
+} vertices_t;
+
+/**
+ * An axis-aligned bounding box, given by its bottom left and top right corners.
+ */
+typedef struct {
+  vector_t min;
+  vector_t max;
+} aabb_t;
+
 /**
  * Allocates memory for a new list with space for the given number of elements.
  * The list is initially empty.
@@ -117,6 +142,72 @@ void polygon_translate(list_t *polygon, vector_t translation);
  */
 void polygon_rotate(list_t *polygon, double angle, vector_t point);
 
+/**
+ * Copies a list of vertices into a newly allocated packed array.
+ * The list is not modified; the returned array must be free()d.
+ *
+ * @param polygon the list of vertices that make up the polygon
+ * @return the same vertices, packed into one array
+ */
+vertices_t vertices_from_list(list_t *polygon);
+
+/**
+ * Computes the area of a packed polygon.
+ * See polygon_area().
+ *
+ * @param polygon the vertices of the polygon, in counterclockwise order
+ * @return the area of the polygon
+ */
+double vertices_area(vertices_t polygon);
+
+/**
+ * Computes the center of mass of a packed polygon.
+ * See polygon_centroid().
+ *
+ * @param polygon the vertices of the polygon, in counterclockwise order
+ * @return the centroid of the polygon
+ */
+vector_t vertices_centroid(vertices_t polygon);
+
+/**
+ * Translates all vertices in a packed polygon by a given vector.
+ * Note: mutates the original polygon.
+ *
+ * @param polygon the vertices of the polygon
+ * @param translation the vector to add to each vertex's position
+ */
+void vertices_translate(vertices_t polygon, vector_t translation);
+
+/**
+ * Rotates vertices in a packed polygon by a given angle about a given point.
+ * Note: mutates the original polygon.
+ *
+ * @param polygon the vertices of the polygon
+ * @param angle the angle to rotate the polygon, in radians.
+ * A positive angle means counterclockwise.
+ * @param point the point to rotate around
+ */
+void vertices_rotate(vertices_t polygon, double angle, vector_t point);
+
+/**
+ * Computes the smallest axis-aligned box containing a packed polygon.
+ *
+ * @param polygon the vertices of the polygon
+ * @return the bounding box of the vertices
+ */
+aabb_t vertices_bounds(vertices_t polygon);
+
+/**
+ * Computes the unit normal of each edge of a polygon.
+ * The normal of the edge from vertex i to vertex i + 1 is the edge direction
+ * rotated a quarter turn clockwise, i.e. it points out of a counterclockwise
+ * polygon.
+ *
+ * @param polygon the vertices of the polygon
+ * @param normals an array with room for one normal per vertex
+ */
+void vertices_edge_normals(vertices_t polygon, vector_t *normals);
+
 /**
  * Gets color of the polygon.
  *
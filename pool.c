@@ -0,0 +1,81 @@
+#include "pool.h"
+#include "list.h"
+#include <assert.h>
+#include <stdlib.h>
+
+// stored just before each object; max_align_t keeps the object aligned
+typedef union slot_header {
+  struct {
+    pool_t *pool;
+    // the next free slot, while this one is free
+    union slot_header *next;
+  } slot;
+  max_align_t align;
+} slot_header_t;
+
+typedef struct pool {
+  size_t object_size;
+  // header plus object, rounded up to keep the next header aligned
+  size_t slot_size;
+  size_t slab_objects;
+  list_t *slabs;
+  slot_header_t *free_list;
+  size_t in_use;
+} pool_t;
+
+pool_t *pool_init(size_t object_size, size_t slab_objects) {
+  assert(object_size > 0);
+  assert(slab_objects > 0);
+  pool_t *pool = malloc(sizeof(pool_t));
+  assert(pool != NULL);
+  pool->object_size = object_size;
+  size_t align = sizeof(slot_header_t);
+  pool->slot_size =
+      sizeof(slot_header_t) + (object_size + align - 1) / align * align;
+  pool->slab_objects = slab_objects;
+  pool->slabs = list_init(1, free);
+  pool->free_list = NULL;
+  pool->in_use = 0;
+  return pool;
+}
+
+void pool_destroy(pool_t *pool) {
+  list_free(pool->slabs);
+  free(pool);
+}
+
+// allocates another slab and threads its slots onto the free list
+static void pool_grow(pool_t *pool) {
+  char *slab = malloc(pool->slot_size * pool->slab_objects);
+  assert(slab != NULL);
+  list_add(pool->slabs, slab);
+  for (size_t i = pool->slab_objects; i > 0; i--) {
+    slot_header_t *header = (slot_header_t *)(slab + (i - 1) * pool->slot_size);
+    header->slot.pool = pool;
+    header->slot.next = pool->free_list;
+    pool->free_list = header;
+  }
+}
+
+void *pool_alloc(pool_t *pool) {
+  if (pool->free_list == NULL) {
+    pool_grow(pool);
+  }
+  slot_header_t *header = pool->free_list;
+  pool->free_list = header->slot.next;
+  pool->in_use++;
+  return header + 1;
+}
+
+void pool_free(void *object) {
+  slot_header_t *header = (slot_header_t *)object - 1;
+  pool_t *pool = header->slot.pool;
+  assert(pool->in_use > 0);
+  header->slot.next = pool->free_list;
+  pool->free_list = header;
+  pool->in_use--;
+}
+
+size_t pool_object_size(pool_t *pool) { return pool->object_size; }
+
+size_t pool_in_use(pool_t *pool) { return pool->in_use; }
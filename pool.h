@@ -0,0 +1,65 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stddef.h>
+
+/**
+ * A pool of fixed-size objects.
+ * Objects are carved out of large slabs and recycled through a free list,
+ * so allocating or freeing one takes constant time and only calls malloc()
+ * when every slab is full. Each object remembers the pool it came from,
+ * so pool_free() can be used anywhere a free_func_t is expected.
+ */
+typedef struct pool pool_t;
+
+/**
+ * Allocates memory for an empty pool.
+ * Asserts that the required memory is allocated.
+ *
+ * @param object_size the size in bytes of each object in the pool
+ * @param slab_objects the number of objects to allocate at once
+ * @return a pointer to the newly allocated pool
+ */
+pool_t *pool_init(size_t object_size, size_t slab_objects);
+
+/**
+ * Releases the memory allocated for a pool, including every object in it.
+ * Objects that have not been returned with pool_free() become invalid.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ */
+void pool_destroy(pool_t *pool);
+
+/**
+ * Takes an object from a pool, growing the pool if it is empty.
+ * The object is uninitialized and aligned for any type.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return a pointer to the object
+ */
+void *pool_alloc(pool_t *pool);
+
+/**
+ * Returns an object to the pool it was allocated from.
+ *
+ * @param object a pointer returned from pool_alloc()
+ */
+void pool_free(void *object);
+
+/**
+ * Gets the size of the objects in a pool.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return the object size passed to pool_init()
+ */
+size_t pool_object_size(pool_t *pool);
+
+/**
+ * Gets the number of objects currently allocated from a pool.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return the number of objects allocated and not yet freed
+ */
+size_t pool_in_use(pool_t *pool);
+
+#endif // #ifndef __POOL_H__
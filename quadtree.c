@@ -0,0 +1,197 @@
+#include "quadtree.h"
+#include "vector.h"
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+const size_t START_NODES = 64;
+// points closer together than the tree can split are merged into one leaf
+#define MAX_QUADTREE_DEPTH 48
+// a walk holds at most three siblings for each level above the deepest and
+// the four children of the deepest node it opens
+#define WALK_STACK_SIZE (3 * MAX_QUADTREE_DEPTH + 4)
+
+typedef struct quad_node {
+  // center and half the side length of the node's square
+  vector_t center;
+  double half;
+  double mass;
+  // sum of mass * position, divided by mass once the tree is built
+  vector_t mass_center;
+  // index of the first of four children, or 0 for a leaf
+  size_t children;
+  bool occupied;
+} quad_node_t;
+
+typedef struct quadtree {
+  quad_node_t *nodes;
+  size_t size;
+  size_t capacity;
+} quadtree_t;
+
+quadtree_t *quadtree_init(void) {
+  quadtree_t *tree = malloc(sizeof(quadtree_t));
+  assert(tree != NULL);
+  tree->nodes = malloc(sizeof(quad_node_t) * START_NODES);
+  assert(tree->nodes != NULL);
+  tree->size = 0;
+  tree->capacity = START_NODES;
+  return tree;
+}
+
+void quadtree_free(quadtree_t *tree) {
+  free(tree->nodes);
+  free(tree);
+}
+
+// appends an empty node covering the given square, returning its index
+static size_t quadtree_add_node(quadtree_t *tree, vector_t center,
+                                double half) {
+  if (tree->size == tree->capacity) {
+    tree->capacity *= 2;
+    tree->nodes = realloc(tree->nodes, sizeof(quad_node_t) * tree->capacity);
+    assert(tree->nodes != NULL);
+  }
+  tree->nodes[tree->size] = (quad_node_t){.center = center,
+                                          .half = half,
+                                          .mass = 0.0,
+                                          .mass_center = VEC_ZERO,
+                                          .children = 0,
+                                          .occupied = false};
+  return tree->size++;
+}
+
+// picks which of a node's four children contains a point
+static size_t quadtree_quadrant(quad_node_t *node, vector_t point) {
+  return (point.x >= node->center.x ? 1 : 0) +
+         (point.y >= node->center.y ? 2 : 0);
+}
+
+static void quadtree_split(quadtree_t *tree, size_t index) {
+  double half = tree->nodes[index].half / 2;
+  vector_t center = tree->nodes[index].center;
+  size_t first = tree->size;
+  for (size_t i = 0; i < 4; i++) {
+    vector_t offset = {.x = (i & 1) ? half : -half,
+                       .y = (i & 2) ? half : -half};
+    quadtree_add_node(tree, vec_add(center, offset), half);
+  }
+  tree->nodes[index].children = first;
+}
+
+static void quadtree_insert(quadtree_t *tree, vector_t point, double mass) {
+  size_t index = 0;
+  for (size_t depth = 0;; depth++) {
+    quad_node_t *node = &tree->nodes[index];
+    if (!node->occupied) {
+      node->occupied = true;
+      node->mass = mass;
+      node->mass_center = vec_multiply(mass, point);
+      return;
+    }
+
+    if (node->children == 0) {
+      if (depth >= MAX_QUADTREE_DEPTH) {
+        node->mass += mass;
+        node->mass_center =
+            vec_add(node->mass_center, vec_multiply(mass, point));
+        return;
+      }
+      // moves the point already in this leaf down into a child
+      double old_mass = node->mass;
+      vector_t old_sum = node->mass_center;
+      vector_t old_point = vec_multiply(1.0 / old_mass, old_sum);
+      quadtree_split(tree, index);
+      node = &tree->nodes[index];
+      quad_node_t *child =
+          &tree->nodes[node->children + quadtree_quadrant(node, old_point)];
+      child->occupied = true;
+      child->mass = old_mass;
+      child->mass_center = old_sum;
+    }
+
+    node->mass += mass;
+    node->mass_center = vec_add(node->mass_center, vec_multiply(mass, point));
+    index = node->children + quadtree_quadrant(node, point);
+  }
+}
+
+void quadtree_build(quadtree_t *tree, const vector_t *positions,
+                    const double *masses, size_t count) {
+  // finds the square containing every point
+  vector_t min = {.x = INFINITY, .y = INFINITY};
+  vector_t max = {.x = -INFINITY, .y = -INFINITY};
+  for (size_t i = 0; i < count; i++) {
+    if (!(masses[i] > 0.0 && isfinite(masses[i]))) {
+      continue;
+    }
+    min.x = fmin(min.x, positions[i].x);
+    min.y = fmin(min.y, positions[i].y);
+    max.x = fmax(max.x, positions[i].x);
+    max.y = fmax(max.y, positions[i].y);
+  }
+
+  tree->size = 0;
+  if (min.x > max.x) {
+    quadtree_add_node(tree, VEC_ZERO, 1.0);
+    return;
+  }
+  double half = fmax(max.x - min.x, max.y - min.y) / 2;
+  // keeps points on the far edges strictly inside the root
+  half = half > 0.0 ? half * (1 + 1e-9) : 1.0;
+  quadtree_add_node(tree, vec_multiply(0.5, vec_add(min, max)), half);
+
+  for (size_t i = 0; i < count; i++) {
+    if (masses[i] > 0.0 && isfinite(masses[i])) {
+      quadtree_insert(tree, positions[i], masses[i]);
+    }
+  }
+  for (size_t i = 0; i < tree->size; i++) {
+    if (tree->nodes[i].occupied) {
+      tree->nodes[i].mass_center =
+          vec_multiply(1.0 / tree->nodes[i].mass, tree->nodes[i].mass_center);
+    }
+  }
+}
+
+vector_t quadtree_field(const quadtree_t *tree, vector_t point, double theta,
+                        double min_dist) {
+  vector_t field = VEC_ZERO;
+  if (tree->size == 0 || !tree->nodes[0].occupied) {
+    return field;
+  }
+
+  double theta_squared = theta * theta;
+  double min_dist_squared = min_dist * min_dist;
+  // each caller walks with its own stack, so threads can share the tree
+  size_t stack[WALK_STACK_SIZE];
+  size_t top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    const quad_node_t *node = &tree->nodes[stack[--top]];
+    double rx = node->mass_center.x - point.x;
+    double ry = node->mass_center.y - point.y;
+    double dist_squared = rx * rx + ry * ry;
+    double size = 2 * node->half;
+
+    // opens the node unless it is a leaf or far enough away
+    if (node->children != 0 && size * size >= theta_squared * dist_squared) {
+      assert(top + 4 <= WALK_STACK_SIZE);
+      for (size_t i = 0; i < 4; i++) {
+        if (tree->nodes[node->children + i].occupied) {
+          stack[top++] = node->children + i;
+        }
+      }
+      continue;
+    }
+
+    if (dist_squared < min_dist_squared) {
+      continue;
+    }
+    double scale = node->mass / (dist_squared * sqrt(dist_squared));
+    field.x += scale * rx;
+    field.y += scale * ry;
+  }
+  return field;
+}
@@ -0,0 +1,62 @@
+#ifndef __QUADTREE_H__
+#define __QUADTREE_H__
+
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * A Barnes-Hut quadtree over a set of point masses.
+ * Each node stores the total mass and center of mass of the points inside it,
+ * so the pull of a distant cluster can be approximated by a single mass.
+ * The tree's memory is reused between builds, so rebuilding it every tick
+ * does not allocate once it has grown to fit the points.
+ */
+typedef struct quadtree quadtree_t;
+
+/**
+ * Allocates memory for an empty quadtree.
+ * Asserts that the required memory is successfully allocated.
+ *
+ * @return the new quadtree
+ */
+quadtree_t *quadtree_init(void);
+
+/**
+ * Releases the memory allocated for a quadtree.
+ *
+ * @param tree a pointer to a quadtree returned from quadtree_init()
+ */
+void quadtree_free(quadtree_t *tree);
+
+/**
+ * Rebuilds a quadtree over the given point masses,
+ * replacing whatever the tree held before.
+ * Points with a mass that is not positive and finite are ignored.
+ *
+ * @param tree a pointer to a quadtree returned from quadtree_init()
+ * @param positions the position of each point
+ * @param masses the mass of each point
+ * @param count the number of points
+ */
+void quadtree_build(quadtree_t *tree, const vector_t *positions,
+                    const double *masses, size_t count);
+
+/**
+ * Computes the gravitational field at a point due to the masses in the tree,
+ * i.e. the sum of m * r / |r|^3 where r points from the point to each mass.
+ * Multiply by G and the mass at the point to get the force on it.
+ * A node whose size divided by its distance is less than theta is treated as
+ * a single mass at its center of mass; theta = 0 gives the exact sum.
+ * Masses closer than min_dist are skipped, which also skips the point itself.
+ * The tree is only read, so several threads may call this at once.
+ *
+ * @param tree a pointer to a quadtree built with quadtree_build()
+ * @param point the point to compute the field at
+ * @param theta the opening angle
+ * @param min_dist the distance below which masses are ignored
+ * @return the field at the point
+ */
+vector_t quadtree_field(const quadtree_t *tree, vector_t point, double theta,
+                        double min_dist);
+
+#endif // #ifndef __QUADTREE_H__
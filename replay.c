@@ -0,0 +1,229 @@
+// Replays a session recorded with -DRECORD_INPUT (see emscripten.c) without
+// a window, for profiling and regression benchmarks. This file replaces
+// sdl_wrapper.c: the demo runs through the usual emscripten.c loop, but its
+// key events and measured dts come from the recording, nothing is drawn and
+// nothing waits for vsync, so the session reruns exactly, as fast as the CPU
+// allows. To replay a recording of game.c (the gcc command is a single line):
+//
+//   gcc -O2 -pthread -DREPLAY_INPUT='"session.rec"' -o replay replay.c
+//       emscripten.c game.c body.c collision.c forces.c list.c polygon.c
+//       pool.c quadtree.c scene.c shape.c threadpool.c vector.c -lm
+//   ./replay
+//
+// Build it with the same PHYSICS_HZ the session was recorded with.
+// When the recording ends, the run is summarized as frames per second.
+
+#include "input_stream.h"
+#include "sdl_wrapper.h"
+#include "state.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifndef REPLAY_INPUT
+#define REPLAY_INPUT "input.rec"
+#endif
+
+// the whole recording, read when the demo first needs it
+static uint8_t *replay_data = NULL;
+static size_t replay_size = 0;
+static size_t replay_position = 0;
+// the keyboard state handed to the key handler
+static uint8_t replay_keys[INPUT_STREAM_KEYS];
+static size_t replay_frames = 0;
+static double replay_start = 0.0;
+
+static key_handler_t key_handler = NULL;
+static double fixed_dt = 0.0;
+static double interpolation = 1.0;
+
+static double now(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+static void replay_read(void *out, size_t size) {
+  assert(size <= replay_size - replay_position);
+  memcpy(out, replay_data + replay_position, size);
+  replay_position += size;
+}
+
+// finds the end of the last whole record, dropping a record cut in half
+static size_t replay_complete_size(size_t position) {
+  while (position < replay_size) {
+    size_t record = 1;
+    switch (replay_data[position]) {
+    case INPUT_TIME:
+      record += sizeof(double);
+      break;
+    case INPUT_KEY: {
+      size_t fields = sizeof(uint8_t) + sizeof(double);
+      uint16_t count;
+      if (replay_size - position < record + fields + sizeof(count)) {
+        return position;
+      }
+      memcpy(&count, replay_data + position + record + fields, sizeof(count));
+      record += fields + sizeof(count) + sizeof(uint16_t) * count;
+      break;
+    }
+    case INPUT_POLL:
+    case INPUT_QUIT:
+      break;
+    default:
+      assert(false);
+    }
+    if (replay_size - position < record) {
+      return position;
+    }
+    position += record;
+  }
+  return position;
+}
+
+static void replay_load(void) {
+  if (replay_data != NULL) {
+    return;
+  }
+  FILE *file = fopen(REPLAY_INPUT, "rb");
+  assert(file != NULL);
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  assert(size >= 0);
+  fseek(file, 0, SEEK_SET);
+  replay_size = size;
+  replay_data = malloc(replay_size > 0 ? replay_size : 1);
+  assert(replay_data != NULL);
+  size_t read = fread(replay_data, 1, replay_size, file);
+  assert(read == replay_size);
+  fclose(file);
+
+  char magic[sizeof(INPUT_STREAM_MAGIC) - 1];
+  uint32_t version;
+  replay_read(magic, sizeof(magic));
+  replay_read(&version, sizeof(version));
+  assert(memcmp(magic, INPUT_STREAM_MAGIC, sizeof(magic)) == 0);
+  assert(version == INPUT_STREAM_VERSION);
+  replay_size = replay_complete_size(replay_position);
+  replay_start = now();
+}
+
+// a recording cut short, e.g. by a crash, ends as if the window was closed
+static input_record_t replay_next(void) {
+  if (replay_position == replay_size) {
+    return INPUT_QUIT;
+  }
+  uint8_t tag;
+  replay_read(&tag, sizeof(tag));
+  return tag;
+}
+
+// passes a recorded key event to the demo's key handler
+static void replay_key(state_t *state) {
+  uint8_t event_type;
+  double held_time;
+  uint16_t count;
+  replay_read(&event_type, sizeof(event_type));
+  replay_read(&held_time, sizeof(held_time));
+  replay_read(&count, sizeof(count));
+  memset(replay_keys, 0, sizeof(replay_keys));
+  for (uint16_t i = 0; i < count; i++) {
+    uint16_t scancode;
+    replay_read(&scancode, sizeof(scancode));
+    assert(scancode < INPUT_STREAM_KEYS);
+    replay_keys[scancode] = 1;
+  }
+  if (key_handler != NULL) {
+    key_handler(replay_keys, event_type, held_time, state);
+  }
+}
+
+static void replay_finish(void) {
+  double total = now() - replay_start;
+  // one key=value line, like headless.c
+  printf("frames=%zu seconds=%.3f frames_per_sec=%.1f\n", replay_frames,
+         total, total > 0.0 ? replay_frames / total : 0.0);
+  free(replay_data);
+  replay_data = NULL;
+}
+
+void sdl_init(vector_t min, vector_t max) {}
+
+bool sdl_is_done(state_t *state) {
+  replay_load();
+  while (true) {
+    switch (replay_next()) {
+    case INPUT_KEY:
+      replay_key(state);
+      break;
+    case INPUT_POLL:
+      replay_frames++;
+      return false;
+    case INPUT_QUIT:
+      replay_finish();
+      return true;
+    default:
+      // a dt here means the demo ticked differently than when recorded
+      assert(false);
+    }
+  }
+}
+
+void sdl_clear(void) {}
+
+void sdl_draw_polygon(list_t *points, rgb_color_t color) {}
+
+void sdl_draw_vertices(vertices_t points, rgb_color_t color) {}
+
+void sdl_draw_body(body_t *body) {}
+
+void sdl_draw_sprite(const char *im_path, vector_t center, vector_t dim) {}
+
+bool sdl_preload_sprite(const char *im_path) { return true; }
+
+void sdl_evict_sprite(const char *im_path) {}
+
+void sdl_evict_all_sprites(void) {}
+
+void sdl_show(void) {}
+
+void sdl_render_scene(scene_t *scene) {}
+
+void sdl_on_key(key_handler_t handler) { key_handler = handler; }
+
+double time_since_last_tick(void) {
+  if (fixed_dt > 0.0) {
+    return fixed_dt;
+  }
+  replay_load();
+  // no time passes after a recording cut short; sdl_is_done() then ends it
+  if (replay_position == replay_size) {
+    return 0.0;
+  }
+  input_record_t tag = replay_next();
+  assert(tag == INPUT_TIME);
+  double dt;
+  replay_read(&dt, sizeof(dt));
+  return dt;
+}
+
+void sdl_set_fixed_dt(double dt) {
+  assert(dt >= 0.0);
+  fixed_dt = dt;
+}
+
+void sdl_record_input(const char *path) {}
+
+void sdl_set_rendering(bool enabled) {}
+
+void sdl_set_interpolation(double alpha) {
+  assert(0.0 <= alpha && alpha <= 1.0);
+  interpolation = alpha;
+}
+
+double sdl_get_interpolation(void) { return interpolation; }
+
+void sdl_wait(double seconds) {}
@@ -2,10 +2,16 @@
 #include "collision.h"
 #include "forces.h"
 #include "list.h"
+#include "pool.h"
+#include "stats.h"
+#include "threadpool.h"
+#include "trace.h"
 #include "vector.h"
 #include <assert.h>
 #include <math.h>
+#include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -13,17 +19,142 @@ const size_t START_BODIES = 30;
 const double MIN_DIST = 5.0;
 const double RESET_DIST = 30.0;
 
+// broad phase constants
+const double DEFAULT_CELL_SIZE = 50.0;
+const size_t GRID_BUCKETS = 4096;
+const size_t MAX_BODY_CELLS = 64;
+const size_t START_HASH_BUCKETS = 64;
+// number of objects each memory pool allocates at once
+const size_t POOL_SLAB_OBJECTS = 64;
+// pooled aux values are rounded up to a multiple of this many bytes
+const size_t AUX_SIZE_STEP = 16;
+
+// threads each new scene ticks on, including the caller's; build with
+// -DSCENE_THREADS=0 to use one per processor
+#ifndef SCENE_THREADS
+#define SCENE_THREADS 1
+#endif
+// the fewest forces or bodies worth handing to another thread
+const size_t FORCE_CHUNK_SIZE = 32;
+const size_t BODY_CHUNK_SIZE = 256;
+// pieces per thread, so that uneven pieces still balance out
+const size_t CHUNKS_PER_THREAD = 4;
+
+// new scenes share one set of threads; a scene ticked while another is
+// using them runs on its own thread instead
+static thread_pool_t *shared_threads = NULL;
+static pthread_once_t shared_threads_once = PTHREAD_ONCE_INIT;
+
+static void shared_threads_init(void) {
+  shared_threads = thread_pool_init(SCENE_THREADS);
+}
+
 typedef struct force {
   force_creator_t forcer;
   void *aux;
   free_func_t freer;
   list_t *bodies;
-  // collision_info_t collision_info; // where do we use this
+  // one link per entry in bodies, so removed bodies can find their forces.
+  // Forces on at most two bodies keep their links inline.
+  body_link_t *links;
+  body_link_t inline_links[2];
+  struct scene *scene;
+  // whether this is a generic collision, dispatched by the broad phase
+  bool collision;
+  // set once a body the force acts on is removed; freed by the next sweep
+  bool dead;
 } force_t;
 
+// a body's place in the broad phase grid, shared by all pairs using the body
+typedef struct grid_record {
+  body_t *body;
+  size_t index;
+  size_t pairs;
+  aabb_t bounds;
+  bool inserted;
+  // whether the body was asleep when the bounds were last refreshed;
+  // sleeping bodies do not move, so their bounds stay valid until they wake
+  bool asleep;
+  // bodies spanning too many cells are tested against every other body
+  bool oversize;
+  // static bodies stay out of the grid and are found through the BVH
+  bool fixed;
+  long min_x;
+  long min_y;
+  long max_x;
+  long max_y;
+} grid_record_t;
+
+// one cell covered by a body, stored in the grid bucket for that cell
+typedef struct cell_entry {
+  long x;
+  long y;
+  grid_record_t *record;
+} cell_entry_t;
+
+// a node of the static bodies' bounding volume hierarchy. Nodes are stored
+// depth first, so an inner node's children follow it and skip is the index
+// just past its subtree. Leaves hold one record each
+typedef struct bvh_node {
+  aabb_t bounds;
+  grid_record_t *record;
+  size_t skip;
+} bvh_node_t;
+
+// all the collision forces registered between two bodies
+typedef struct collision_pair {
+  body_t *body1;
+  body_t *body2;
+  list_t *forces;
+  size_t seen_tick;
+  bool colliding;
+  bool in_contact;
+} collision_pair_t;
+
 typedef struct scene {
   list_t *bodies;
+  // bodies that never move, which are never ticked
+  list_t *static_bodies;
+  // whether a static body may have been removed since the last sweep
+  bool statics_removed;
   list_t *forces;
+  // broad phase: a grid_record_t per body with a collision force,
+  // looked up by body, and a spatial hash of the cells they cover
+  list_t *records;
+  list_t **record_map;
+  size_t record_buckets;
+  list_t **grid;
+  list_t *oversize;
+  double cell_size;
+  // the records of static bodies, and a BVH over them that is rebuilt
+  // whenever one is added or dropped
+  list_t *fixed_records;
+  bvh_node_t *bvh;
+  size_t bvh_nodes;
+  bool bvh_dirty;
+  // collision forces keyed by their (unordered) pair of bodies
+  list_t **pairs;
+  size_t pair_buckets;
+  size_t num_pairs;
+  // pairs that were colliding at the end of the last tick
+  list_t *contacts;
+  size_t tick;
+  // forces marked dead but not yet removed from the forces list
+  size_t dead_forces;
+  // recycled memory for forces, broad phase objects and aux values
+  pool_t *force_pool;
+  pool_t *record_pool;
+  pool_t *cell_pool;
+  pool_t *pair_pool;
+  // one pool per rounded aux size
+  list_t *aux_pools;
+  // threads the tick is split across, or NULL to tick on the caller's only
+  thread_pool_t *threads;
+  // one log per piece of the force creators, replayed in order
+  list_t *force_logs;
+  size_t force_chunks;
+  size_t body_chunks;
+  double tick_dt;
 } scene_t;
 
 scene_t *scene_init(void) {
@@ -37,13 +168,124 @@ scene_t *scene_init(void) {
   assert(empty_forces != NULL);
 
   empty_scene->bodies = empty_bodies;
+  empty_scene->static_bodies = list_init(0, (void *)body_free);
+  empty_scene->statics_removed = false;
   empty_scene->forces = empty_forces;
+
+  empty_scene->records = list_init(START_BODIES, pool_free);
+  empty_scene->record_buckets = START_HASH_BUCKETS;
+  empty_scene->record_map = malloc(sizeof(list_t *) * START_HASH_BUCKETS);
+  assert(empty_scene->record_map != NULL);
+  for (size_t i = 0; i < START_HASH_BUCKETS; i++) {
+    empty_scene->record_map[i] = list_init(0, NULL);
+  }
+  // buckets are made on their first insert, so small scenes only pay for
+  // the cells they use
+  empty_scene->grid = calloc(GRID_BUCKETS, sizeof(list_t *));
+  assert(empty_scene->grid != NULL);
+  empty_scene->oversize = list_init(0, NULL);
+  empty_scene->cell_size = DEFAULT_CELL_SIZE;
+  empty_scene->fixed_records = list_init(0, pool_free);
+  empty_scene->bvh = NULL;
+  empty_scene->bvh_nodes = 0;
+  empty_scene->bvh_dirty = false;
+
+  empty_scene->pair_buckets = START_HASH_BUCKETS;
+  empty_scene->pairs = malloc(sizeof(list_t *) * START_HASH_BUCKETS);
+  assert(empty_scene->pairs != NULL);
+  for (size_t i = 0; i < START_HASH_BUCKETS; i++) {
+    empty_scene->pairs[i] = list_init(0, NULL);
+  }
+  empty_scene->num_pairs = 0;
+  empty_scene->contacts = list_init(0, NULL);
+  empty_scene->tick = 0;
+  empty_scene->dead_forces = 0;
+  empty_scene->force_pool = pool_init(sizeof(force_t), POOL_SLAB_OBJECTS);
+  empty_scene->record_pool =
+      pool_init(sizeof(grid_record_t), POOL_SLAB_OBJECTS);
+  empty_scene->cell_pool = pool_init(sizeof(cell_entry_t), POOL_SLAB_OBJECTS);
+  empty_scene->pair_pool =
+      pool_init(sizeof(collision_pair_t), POOL_SLAB_OBJECTS);
+  empty_scene->aux_pools = list_init(1, (free_func_t)pool_destroy);
+  empty_scene->threads = NULL;
+  if (SCENE_THREADS != 1) {
+    // scenes may be created on several threads at once
+    pthread_once(&shared_threads_once, shared_threads_init);
+    empty_scene->threads = shared_threads;
+  }
+  empty_scene->force_logs = list_init(0, (free_func_t)force_log_free);
+  empty_scene->force_chunks = 0;
+  empty_scene->body_chunks = 0;
+  empty_scene->tick_dt = 0.0;
   return empty_scene;
 }
 
+// marks a force to be removed from its scene by the next sweep
+static void force_kill(force_t *force) {
+  if (!force->dead) {
+    force->dead = true;
+    force->scene->dead_forces++;
+  }
+}
+
+// frees a body, killing the forces still on it; they may belong to another
+// scene, which sweeps them on its next tick
+static void body_discard(body_t *body) {
+  list_t *links = body_get_links(body);
+  for (size_t i = 0; i < list_size(links); i++) {
+    force_kill(((body_link_t *)list_get(links, i))->owner);
+  }
+  body_free(body);
+}
+
 void scene_free(scene_t *scene) {
-  list_free(scene->bodies);
+  // forces go first so they can unlink themselves from the bodies
   list_free(scene->forces);
+  while (list_size(scene->bodies) > 0) {
+    body_discard(list_remove(scene->bodies, list_size(scene->bodies) - 1));
+  }
+  list_free(scene->bodies);
+  while (list_size(scene->static_bodies) > 0) {
+    body_discard(list_remove(scene->static_bodies,
+                             list_size(scene->static_bodies) - 1));
+  }
+  list_free(scene->static_bodies);
+
+  list_free(scene->records);
+  list_free(scene->fixed_records);
+  free(scene->bvh);
+  for (size_t i = 0; i < scene->record_buckets; i++) {
+    list_free(scene->record_map[i]);
+  }
+  free(scene->record_map);
+  for (size_t i = 0; i < GRID_BUCKETS; i++) {
+    if (scene->grid[i] != NULL) {
+      list_free(scene->grid[i]);
+    }
+  }
+  free(scene->grid);
+  list_free(scene->oversize);
+
+  for (size_t i = 0; i < scene->pair_buckets; i++) {
+    list_t *bucket = scene->pairs[i];
+    for (size_t j = 0; j < list_size(bucket); j++) {
+      collision_pair_t *pair = list_get(bucket, j);
+      list_free(pair->forces);
+      pool_free(pair);
+    }
+    list_free(bucket);
+  }
+  free(scene->pairs);
+  list_free(scene->contacts);
+
+  // every pooled object has been returned by now
+  pool_destroy(scene->force_pool);
+  pool_destroy(scene->record_pool);
+  pool_destroy(scene->cell_pool);
+  pool_destroy(scene->pair_pool);
+  list_free(scene->aux_pools);
+  // the threads belong to whoever set them, or are shared
+  list_free(scene->force_logs);
   free(scene);
 }
 
@@ -51,12 +293,18 @@ void force_free(force_t *force) {
   if (force->freer != NULL) {
     force->freer(force->aux);
   }
+  for (size_t i = 0; i < list_size(force->bodies); i++) {
+    body_unlink(&force->links[i]);
+  }
   for (size_t i = 0; i < list_size(force->bodies); i++) {
     list_remove(force->bodies, i);
     i--;
   }
   list_free(force->bodies);
-  free(force);
+  if (force->links != force->inline_links) {
+    free(force->links);
+  }
+  pool_free(force);
 }
 
 void gravity_creator(void *aux) {
@@ -160,22 +408,27 @@ void physics_collision_creator(body_t *body1, body_t *body2, vector_t axis,
   body_add_impulse(body2, impulse_12);
 }
 
-// applies collision handler
-void generic_collision_creator(void *aux) {
-  collision_info_t info = find_collision(
-      body_get_vertices(aux_generic_get_body1((aux_generic_t *)aux)),
-      body_get_vertices(aux_generic_get_body2((aux_generic_t *)aux)));
+// calls the collision handler once per contact, given the narrow phase result
+static void apply_collision(aux_generic_t *aux, collision_info_t info) {
+  STATS_ADD(STAT_COLLISION_FORCES, 1);
   if (info.collided == 1 && aux_generic_get_flagged(aux) == false) {
-    aux_generic_set_flagged((aux_generic_t *)aux);
-    aux_generic_get_handler((aux_generic_t *)aux)(
-        aux_generic_get_body1((aux_generic_t *)aux),
-        aux_generic_get_body2((aux_generic_t *)aux), info.axis,
-        aux_generic_get_aux(aux));
+    aux_generic_set_flagged(aux);
+    aux_generic_get_handler(aux)(aux_generic_get_body1(aux),
+                                 aux_generic_get_body2(aux), info.axis,
+                                 aux_generic_get_aux(aux));
   } else if (info.collided == 0) {
-    aux_generic_set_unflagged((aux_generic_t *)aux);
+    aux_generic_set_unflagged(aux);
   }
 }
 
+// applies collision handler
+void generic_collision_creator(void *aux) {
+  collision_info_t info =
+      find_body_collision(aux_generic_get_body1((aux_generic_t *)aux),
+                          aux_generic_get_body2((aux_generic_t *)aux));
+  apply_collision(aux, info);
+}
+
 void drag_creator(void *aux) {
   // uses drag = - gamma * velocity to find drag force
   vector_t force = vec_multiply((-1) * aux1_get_constant(aux),
@@ -216,6 +469,589 @@ void half_destructive_collision_creator(body_t *body1, body_t *body2,
   body_add_impulse(body2, impulse_12);
 }
 
+// converts a coordinate to the index of the grid cell containing it
+static long grid_cell(double coord, double cell_size) {
+  return (long)floor(coord / cell_size);
+}
+
+// the slot holding the bucket for a cell; NULL until a record is inserted
+// into one of the cells sharing it, and empty if it is NULL
+static list_t **grid_bucket(scene_t *scene, long x, long y) {
+  size_t hash = ((size_t)x * 73856093u) ^ ((size_t)y * 19349663u);
+  return &scene->grid[hash % GRID_BUCKETS];
+}
+
+// adds a record to every cell its bounds cover
+static void grid_insert(scene_t *scene, grid_record_t *record) {
+  aabb_t bounds = record->bounds;
+  double cells_x = floor(bounds.max.x / scene->cell_size) -
+                   floor(bounds.min.x / scene->cell_size) + 1;
+  double cells_y = floor(bounds.max.y / scene->cell_size) -
+                   floor(bounds.min.y / scene->cell_size) + 1;
+  record->inserted = true;
+  // also catches NaN and infinite bounds
+  if (!(cells_x * cells_y <= MAX_BODY_CELLS)) {
+    record->oversize = true;
+    list_add(scene->oversize, record);
+    return;
+  }
+
+  record->oversize = false;
+  record->min_x = grid_cell(bounds.min.x, scene->cell_size);
+  record->min_y = grid_cell(bounds.min.y, scene->cell_size);
+  record->max_x = grid_cell(bounds.max.x, scene->cell_size);
+  record->max_y = grid_cell(bounds.max.y, scene->cell_size);
+  for (long x = record->min_x; x <= record->max_x; x++) {
+    for (long y = record->min_y; y <= record->max_y; y++) {
+      list_t **bucket = grid_bucket(scene, x, y);
+      if (*bucket == NULL) {
+        *bucket = list_init(0, pool_free);
+      }
+      cell_entry_t *entry = pool_alloc(scene->cell_pool);
+      *entry = (cell_entry_t){.x = x, .y = y, .record = record};
+      list_add(*bucket, entry);
+    }
+  }
+}
+
+// removes a record from every cell it was inserted into
+static void grid_remove(scene_t *scene, grid_record_t *record) {
+  if (!record->inserted) {
+    return;
+  }
+  record->inserted = false;
+  if (record->oversize) {
+    for (size_t i = 0; i < list_size(scene->oversize); i++) {
+      if (list_get(scene->oversize, i) == record) {
+        list_swap_remove(scene->oversize, i);
+        break;
+      }
+    }
+    return;
+  }
+
+  for (long x = record->min_x; x <= record->max_x; x++) {
+    for (long y = record->min_y; y <= record->max_y; y++) {
+      list_t *bucket = *grid_bucket(scene, x, y);
+      if (bucket == NULL) {
+        continue;
+      }
+      for (size_t i = 0; i < list_size(bucket); i++) {
+        cell_entry_t *entry = list_get(bucket, i);
+        if (entry->record == record && entry->x == x && entry->y == y) {
+          pool_free(list_swap_remove(bucket, i));
+          break;
+        }
+      }
+    }
+  }
+}
+
+// takes a record out of the records or fixed_records list it is in
+static void record_unlist(scene_t *scene, grid_record_t *record) {
+  list_t *records = record->fixed ? scene->fixed_records : scene->records;
+  list_swap_remove(records, record->index);
+  if (record->index < list_size(records)) {
+    ((grid_record_t *)list_get(records, record->index))->index =
+        record->index;
+  }
+}
+
+// moves the record of a body that has become static out of the grid
+// and into the BVH, which picks it up when it is next rebuilt
+static void record_fix(scene_t *scene, grid_record_t *record) {
+  grid_remove(scene, record);
+  record_unlist(scene, record);
+  record->fixed = true;
+  record->asleep = true;
+  record->bounds = body_get_bounds(record->body);
+  record->index = list_size(scene->fixed_records);
+  list_add(scene->fixed_records, record);
+  scene->bvh_dirty = true;
+}
+
+// refreshes every body's bounds, only moving bodies that changed cells
+static void grid_update(scene_t *scene) {
+  for (size_t i = 0; i < list_size(scene->records); i++) {
+    grid_record_t *record = list_get(scene->records, i);
+    if (body_is_static(record->body)) {
+      record_fix(scene, record);
+      i--;
+      continue;
+    }
+    bool asleep = body_is_asleep(record->body);
+    if (record->inserted && asleep && record->asleep) {
+      continue;
+    }
+    record->asleep = asleep;
+    record->bounds = body_get_bounds(record->body);
+    if (record->inserted && !record->oversize) {
+      aabb_t bounds = record->bounds;
+      if (grid_cell(bounds.min.x, scene->cell_size) == record->min_x &&
+          grid_cell(bounds.min.y, scene->cell_size) == record->min_y &&
+          grid_cell(bounds.max.x, scene->cell_size) == record->max_x &&
+          grid_cell(bounds.max.y, scene->cell_size) == record->max_y) {
+        continue;
+      }
+    }
+    grid_remove(scene, record);
+    grid_insert(scene, record);
+  }
+}
+
+static size_t body_hash(body_t *body, size_t buckets) {
+  return (size_t)(((uintptr_t)body >> 4) * 2654435761u) % buckets;
+}
+
+static grid_record_t *record_find(scene_t *scene, body_t *body) {
+  list_t *bucket = scene->record_map[body_hash(body, scene->record_buckets)];
+  for (size_t i = 0; i < list_size(bucket); i++) {
+    grid_record_t *record = list_get(bucket, i);
+    if (record->body == body) {
+      return record;
+    }
+  }
+  return NULL;
+}
+
+// doubles the number of record buckets once they hold two records on average
+static void record_rehash(scene_t *scene) {
+  size_t new_buckets = scene->record_buckets * 2;
+  list_t **new_map = malloc(sizeof(list_t *) * new_buckets);
+  assert(new_map != NULL);
+  for (size_t i = 0; i < new_buckets; i++) {
+    new_map[i] = list_init(0, NULL);
+  }
+  for (size_t i = 0; i < list_size(scene->records); i++) {
+    grid_record_t *record = list_get(scene->records, i);
+    list_add(new_map[body_hash(record->body, new_buckets)], record);
+  }
+  for (size_t i = 0; i < list_size(scene->fixed_records); i++) {
+    grid_record_t *record = list_get(scene->fixed_records, i);
+    list_add(new_map[body_hash(record->body, new_buckets)], record);
+  }
+  for (size_t i = 0; i < scene->record_buckets; i++) {
+    list_free(scene->record_map[i]);
+  }
+  free(scene->record_map);
+  scene->record_map = new_map;
+  scene->record_buckets = new_buckets;
+}
+
+// gets the grid record for a body, creating it if this is its first pair.
+// Bodies from other scenes can collide with this scene's bodies,
+// so records are tracked per collision pair, not per scene body.
+static void record_acquire(scene_t *scene, body_t *body) {
+  grid_record_t *record = record_find(scene, body);
+  if (record == NULL) {
+    if (list_size(scene->records) + list_size(scene->fixed_records) >=
+        2 * scene->record_buckets) {
+      record_rehash(scene);
+    }
+    record = pool_alloc(scene->record_pool);
+    record->body = body;
+    record->index = list_size(scene->records);
+    record->pairs = 0;
+    // the body joins the grid on the next tick
+    record->inserted = false;
+    record->oversize = false;
+    record->asleep = false;
+    record->fixed = false;
+    list_add(scene->records, record);
+    list_add(scene->record_map[body_hash(body, scene->record_buckets)],
+             record);
+    if (body_is_static(body)) {
+      record_fix(scene, record);
+    }
+  }
+  record->pairs++;
+}
+
+// drops a body's grid record once it is in no more pairs
+static void record_release(scene_t *scene, body_t *body) {
+  grid_record_t *record = record_find(scene, body);
+  assert(record != NULL);
+  record->pairs--;
+  if (record->pairs > 0) {
+    return;
+  }
+
+  grid_remove(scene, record);
+  list_t *bucket = scene->record_map[body_hash(body, scene->record_buckets)];
+  for (size_t i = 0; i < list_size(bucket); i++) {
+    if (list_get(bucket, i) == record) {
+      list_swap_remove(bucket, i);
+      break;
+    }
+  }
+  record_unlist(scene, record);
+  if (record->fixed) {
+    scene->bvh_dirty = true;
+  }
+  pool_free(record);
+}
+
+static size_t pair_hash(body_t *body1, body_t *body2, size_t buckets) {
+  uintptr_t a = (uintptr_t)body1;
+  uintptr_t b = (uintptr_t)body2;
+  if (a > b) {
+    uintptr_t temp = a;
+    a = b;
+    b = temp;
+  }
+  return (size_t)((a >> 4) * 2654435761u ^ (b >> 4) * 40503u) % buckets;
+}
+
+// finds the pair for two bodies in either order, or NULL if there is none
+static collision_pair_t *pair_find(scene_t *scene, body_t *body1,
+                                   body_t *body2) {
+  list_t *bucket =
+      scene->pairs[pair_hash(body1, body2, scene->pair_buckets)];
+  for (size_t i = 0; i < list_size(bucket); i++) {
+    collision_pair_t *pair = list_get(bucket, i);
+    if ((pair->body1 == body1 && pair->body2 == body2) ||
+        (pair->body1 == body2 && pair->body2 == body1)) {
+      return pair;
+    }
+  }
+  return NULL;
+}
+
+// doubles the number of pair buckets once they hold two pairs on average
+static void pair_rehash(scene_t *scene) {
+  size_t new_buckets = scene->pair_buckets * 2;
+  list_t **new_pairs = malloc(sizeof(list_t *) * new_buckets);
+  assert(new_pairs != NULL);
+  for (size_t i = 0; i < new_buckets; i++) {
+    new_pairs[i] = list_init(0, NULL);
+  }
+  for (size_t i = 0; i < scene->pair_buckets; i++) {
+    list_t *bucket = scene->pairs[i];
+    for (size_t j = 0; j < list_size(bucket); j++) {
+      collision_pair_t *pair = list_get(bucket, j);
+      list_add(new_pairs[pair_hash(pair->body1, pair->body2, new_buckets)],
+               pair);
+    }
+    list_free(bucket);
+  }
+  free(scene->pairs);
+  scene->pairs = new_pairs;
+  scene->pair_buckets = new_buckets;
+}
+
+static void pair_add_force(scene_t *scene, force_t *force) {
+  body_t *body1 = aux_generic_get_body1(force->aux);
+  body_t *body2 = aux_generic_get_body2(force->aux);
+  collision_pair_t *pair = pair_find(scene, body1, body2);
+  if (pair == NULL) {
+    if (scene->num_pairs >= 2 * scene->pair_buckets) {
+      pair_rehash(scene);
+    }
+    pair = pool_alloc(scene->pair_pool);
+    pair->body1 = body1;
+    pair->body2 = body2;
+    pair->forces = list_init(1, NULL);
+    pair->seen_tick = 0;
+    pair->colliding = false;
+    pair->in_contact = false;
+    list_add(scene->pairs[pair_hash(body1, body2, scene->pair_buckets)],
+             pair);
+    scene->num_pairs++;
+    record_acquire(scene, body1);
+    record_acquire(scene, body2);
+  }
+  list_add(pair->forces, force);
+  // a collision restored mid-contact must still be unflagged once the bodies
+  // separate, even if the broad phase never tests them again
+  if (aux_generic_get_flagged(force->aux) && !pair->in_contact) {
+    pair->colliding = true;
+    pair->in_contact = true;
+    list_add(scene->contacts, pair);
+  }
+}
+
+// unregisters a collision force, dropping its pair once no forces remain
+static void pair_remove_force(scene_t *scene, force_t *force) {
+  body_t *body1 = aux_generic_get_body1(force->aux);
+  body_t *body2 = aux_generic_get_body2(force->aux);
+  list_t *bucket =
+      scene->pairs[pair_hash(body1, body2, scene->pair_buckets)];
+  collision_pair_t *pair = pair_find(scene, body1, body2);
+  assert(pair != NULL);
+  for (size_t i = 0; i < list_size(pair->forces); i++) {
+    if (list_get(pair->forces, i) == force) {
+      list_remove(pair->forces, i);
+      break;
+    }
+  }
+  if (list_size(pair->forces) > 0) {
+    return;
+  }
+
+  if (pair->in_contact) {
+    for (size_t i = 0; i < list_size(scene->contacts); i++) {
+      if (list_get(scene->contacts, i) == pair) {
+        list_remove(scene->contacts, i);
+        break;
+      }
+    }
+  }
+  for (size_t i = 0; i < list_size(bucket); i++) {
+    if (list_get(bucket, i) == pair) {
+      list_swap_remove(bucket, i);
+      break;
+    }
+  }
+  record_release(scene, pair->body1);
+  record_release(scene, pair->body2);
+  list_free(pair->forces);
+  pool_free(pair);
+  scene->num_pairs--;
+}
+
+// whether both of a pair's bodies were asleep at the start of the broad
+// phase, in which case nothing about the pair can have changed
+static bool pair_asleep(scene_t *scene, collision_pair_t *pair) {
+  return record_find(scene, pair->body1)->asleep &&
+         record_find(scene, pair->body2)->asleep;
+}
+
+// runs the narrow phase once for a pair and hands the result to its handlers
+static void collide_pair(scene_t *scene, grid_record_t *record1,
+                         grid_record_t *record2) {
+  if ((record1->asleep && record2->asleep) ||
+      !aabb_overlap(record1->bounds, record2->bounds)) {
+    return;
+  }
+  collision_pair_t *pair = pair_find(scene, record1->body, record2->body);
+  if (pair == NULL) {
+    return;
+  }
+
+  // each force may list the bodies in either order, so the narrow phase
+  // runs at most once per order
+  collision_info_t info12;
+  collision_info_t info21;
+  bool have12 = false;
+  bool have21 = false;
+  pair->seen_tick = scene->tick;
+  pair->colliding = false;
+  for (size_t i = 0; i < list_size(pair->forces); i++) {
+    force_t *force = list_get(pair->forces, i);
+    if (force->dead) {
+      continue;
+    }
+    aux_generic_t *aux = force->aux;
+    collision_info_t info;
+    if (aux_generic_get_body1(aux) == pair->body1) {
+      if (!have12) {
+        info12 = find_body_collision(pair->body1, pair->body2);
+        have12 = true;
+      }
+      info = info12;
+    } else {
+      if (!have21) {
+        info21 = find_body_collision(pair->body2, pair->body1);
+        have21 = true;
+      }
+      info = info21;
+    }
+    apply_collision(aux, info);
+    pair->colliding = pair->colliding || info.collided;
+  }
+
+  if (pair->colliding && !pair->in_contact) {
+    pair->in_contact = true;
+    list_add(scene->contacts, pair);
+  }
+  // static bodies are only swept once one of them has been removed
+  if (record2->fixed && body_is_removed(record2->body)) {
+    scene->statics_removed = true;
+  }
+}
+
+// the smallest box holding two boxes
+static aabb_t aabb_union(aabb_t bounds1, aabb_t bounds2) {
+  return (aabb_t){.min = {.x = fmin(bounds1.min.x, bounds2.min.x),
+                          .y = fmin(bounds1.min.y, bounds2.min.y)},
+                  .max = {.x = fmax(bounds1.max.x, bounds2.max.x),
+                          .y = fmax(bounds1.max.y, bounds2.max.y)}};
+}
+
+static int record_compare_x(const void *a, const void *b) {
+  const aabb_t *bounds1 = &(*(grid_record_t *const *)a)->bounds;
+  const aabb_t *bounds2 = &(*(grid_record_t *const *)b)->bounds;
+  double center1 = bounds1->min.x + bounds1->max.x;
+  double center2 = bounds2->min.x + bounds2->max.x;
+  return (center1 > center2) - (center1 < center2);
+}
+
+static int record_compare_y(const void *a, const void *b) {
+  const aabb_t *bounds1 = &(*(grid_record_t *const *)a)->bounds;
+  const aabb_t *bounds2 = &(*(grid_record_t *const *)b)->bounds;
+  double center1 = bounds1->min.y + bounds1->max.y;
+  double center2 = bounds2->min.y + bounds2->max.y;
+  return (center1 > center2) - (center1 < center2);
+}
+
+// builds the subtree over some records starting at the given node, splitting
+// them at the median along the longer side of their bounds.
+// Returns the index just past the subtree
+static size_t bvh_build(scene_t *scene, grid_record_t **records, size_t count,
+                        size_t node) {
+  aabb_t bounds = records[0]->bounds;
+  for (size_t i = 1; i < count; i++) {
+    bounds = aabb_union(bounds, records[i]->bounds);
+  }
+  if (count == 1) {
+    scene->bvh[node] =
+        (bvh_node_t){.bounds = bounds, .record = records[0], .skip = node + 1};
+    return node + 1;
+  }
+  bool wide = bounds.max.x - bounds.min.x >= bounds.max.y - bounds.min.y;
+  qsort(records, count, sizeof(grid_record_t *),
+        wide ? record_compare_x : record_compare_y);
+  size_t half = count / 2;
+  size_t right = bvh_build(scene, records, half, node + 1);
+  size_t end = bvh_build(scene, records + half, count - half, right);
+  scene->bvh[node] =
+      (bvh_node_t){.bounds = bounds, .record = NULL, .skip = end};
+  return end;
+}
+
+// rebuilds the BVH if static bodies have been added or dropped since the last
+// build; otherwise static bodies cost nothing from one tick to the next
+static void bvh_update(scene_t *scene) {
+  if (!scene->bvh_dirty) {
+    return;
+  }
+  scene->bvh_dirty = false;
+  size_t count = list_size(scene->fixed_records);
+  // a binary tree with a leaf per record
+  scene->bvh_nodes = count > 0 ? 2 * count - 1 : 0;
+  free(scene->bvh);
+  scene->bvh = NULL;
+  if (count == 0) {
+    return;
+  }
+  scene->bvh = malloc(sizeof(bvh_node_t) * scene->bvh_nodes);
+  grid_record_t **records = malloc(sizeof(grid_record_t *) * count);
+  assert(scene->bvh != NULL && records != NULL);
+  for (size_t i = 0; i < count; i++) {
+    records[i] = list_get(scene->fixed_records, i);
+  }
+  bvh_build(scene, records, count, 0);
+  free(records);
+}
+
+// tests a moving body against every static body whose bounds it overlaps
+static void bvh_query(scene_t *scene, grid_record_t *record) {
+  size_t node = 0;
+  while (node < scene->bvh_nodes) {
+    bvh_node_t *current = &scene->bvh[node];
+    if (!aabb_overlap(current->bounds, record->bounds)) {
+      node = current->skip;
+      continue;
+    }
+    if (current->record != NULL) {
+      collide_pair(scene, record, current->record);
+    }
+    node++;
+  }
+}
+
+// finds overlapping bodies through the grid and dispatches their collisions
+static void broad_phase(scene_t *scene) {
+  scene->tick++;
+  grid_update(scene);
+  bvh_update(scene);
+
+  size_t record_count = list_size(scene->records);
+  for (size_t i = 0; i < record_count; i++) {
+    grid_record_t *record = list_get(scene->records, i);
+    // pairs with a sleeping body are found from the other body,
+    // and pairs of sleeping bodies are not tested at all
+    if (record->oversize || record->asleep) {
+      continue;
+    }
+    for (long x = record->min_x; x <= record->max_x; x++) {
+      for (long y = record->min_y; y <= record->max_y; y++) {
+        list_t *bucket = *grid_bucket(scene, x, y);
+        if (bucket == NULL) {
+          continue;
+        }
+        for (size_t j = 0; j < list_size(bucket); j++) {
+          cell_entry_t *entry = list_get(bucket, j);
+          grid_record_t *other = entry->record;
+          if (entry->x != x || entry->y != y ||
+              (!other->asleep && (uintptr_t)other <= (uintptr_t)record)) {
+            continue;
+          }
+          // only handle the pair in the lowest cell both bodies cover
+          long first_x =
+              record->min_x > other->min_x ? record->min_x : other->min_x;
+          long first_y =
+              record->min_y > other->min_y ? record->min_y : other->min_y;
+          if (x == first_x && y == first_y) {
+            collide_pair(scene, record, other);
+          }
+        }
+      }
+    }
+  }
+
+  // oversize bodies are checked against everything
+  for (size_t i = 0; i < list_size(scene->oversize); i++) {
+    grid_record_t *record = list_get(scene->oversize, i);
+    for (size_t j = 0; j < record_count; j++) {
+      grid_record_t *other = list_get(scene->records, j);
+      if (other == record || !other->inserted ||
+          (other->oversize && (uintptr_t)other < (uintptr_t)record)) {
+        continue;
+      }
+      collide_pair(scene, record, other);
+    }
+  }
+
+  // moving bodies look for static bodies in the BVH; handlers may add
+  // records, so only those there before the tick are tested
+  if (scene->bvh_nodes > 0) {
+    for (size_t i = 0; i < record_count; i++) {
+      grid_record_t *record = list_get(scene->records, i);
+      if (!record->asleep) {
+        bvh_query(scene, record);
+      }
+    }
+  }
+
+  // pairs that stopped touching without being tested are separated now
+  for (size_t i = 0; i < list_size(scene->contacts); i++) {
+    collision_pair_t *pair = list_get(scene->contacts, i);
+    if (pair->seen_tick != scene->tick && !pair_asleep(scene, pair)) {
+      for (size_t j = 0; j < list_size(pair->forces); j++) {
+        aux_generic_set_unflagged(
+            ((force_t *)list_get(pair->forces, j))->aux);
+      }
+      pair->colliding = false;
+    }
+    if (!pair->colliding) {
+      pair->in_contact = false;
+      list_remove(scene->contacts, i);
+      i--;
+    }
+  }
+}
+
+void scene_set_cell_size(scene_t *scene, double cell_size) {
+  assert(cell_size > 0);
+  for (size_t i = 0; i < list_size(scene->records); i++) {
+    grid_remove(scene, list_get(scene->records, i));
+  }
+  scene->cell_size = cell_size;
+}
+
+double scene_get_cell_size(scene_t *scene) { return scene->cell_size; }
+
 size_t scene_bodies(scene_t *scene) { return list_size(scene->bodies); }
 
 size_t scene_forces(scene_t *scene) { return list_size(scene->forces); }
@@ -225,6 +1061,17 @@ body_t *scene_get_body(scene_t *scene, size_t index) {
   return (body_t *)list_get(scene->bodies, index);
 }
 
+force_t *scene_get_force(scene_t *scene, size_t index) {
+  assert(index < scene_forces(scene));
+  return list_get(scene->forces, index);
+}
+
+force_creator_t force_get_forcer(force_t *force) { return force->forcer; }
+
+void *force_get_aux(force_t *force) { return force->aux; }
+
+bool force_is_dead(force_t *force) { return force->dead; }
+
 void scene_add_body(scene_t *scene, body_t *body) {
   list_add(scene->bodies, body);
 }
@@ -239,15 +1086,48 @@ void scene_remove_body(scene_t *scene, size_t index) {
   body_remove(old_body);
 }
 
+void scene_add_static_body(scene_t *scene, body_t *body) {
+  body_set_static(body);
+  list_add(scene->static_bodies, body);
+}
+
+size_t scene_static_bodies(scene_t *scene) {
+  return list_size(scene->static_bodies);
+}
+
+body_t *scene_get_static_body(scene_t *scene, size_t index) {
+  assert(index < scene_static_bodies(scene));
+  return list_get(scene->static_bodies, index);
+}
+
+void scene_remove_static_body(scene_t *scene, size_t index) {
+  body_remove(scene_get_static_body(scene, index));
+  scene->statics_removed = true;
+}
+
 void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer) {
-  force_t *force = malloc(sizeof(force_t));
+  force_t *force = pool_alloc(scene->force_pool);
   force->forcer = forcer;
   force->aux = aux;
   force->freer = freer;
   force->bodies = bodies;
+  force->links = force->inline_links;
+  if (list_size(bodies) > 2) {
+    force->links = malloc(sizeof(body_link_t) * list_size(bodies));
+    assert(force->links != NULL);
+  }
+  for (size_t i = 0; i < list_size(bodies); i++) {
+    body_link(list_get(bodies, i), &force->links[i], force);
+  }
+  force->scene = scene;
+  force->collision = forcer == (force_creator_t)generic_collision_creator;
+  force->dead = false;
   list_add(scene->forces, force);
+  if (force->collision) {
+    pair_add_force(scene, force);
+  }
 }
 
 void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
@@ -256,41 +1136,296 @@ void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux,
   scene_add_bodies_force_creator(scene, forcer, aux, bodies, freer);
 }
 
-void scene_tick(scene_t *scene, double dt) {
-  // calls forces using appropriate forcer
+void *scene_alloc_aux(scene_t *scene, size_t size) {
+  size_t rounded = (size + AUX_SIZE_STEP - 1) / AUX_SIZE_STEP * AUX_SIZE_STEP;
+  for (size_t i = 0; i < list_size(scene->aux_pools); i++) {
+    pool_t *pool = list_get(scene->aux_pools, i);
+    if (pool_object_size(pool) == rounded) {
+      return pool_alloc(pool);
+    }
+  }
+  pool_t *pool = pool_init(rounded, POOL_SLAB_OBJECTS);
+  list_add(scene->aux_pools, pool);
+  return pool_alloc(pool);
+}
+
+void scene_reset(scene_t *scene) {
+  // forces go first so they can unlink themselves from the bodies
+  while (list_size(scene->forces) > 0) {
+    force_t *force = list_remove(scene->forces, list_size(scene->forces) - 1);
+    if (force->collision) {
+      pair_remove_force(scene, force);
+    }
+    force_free(force);
+  }
+  while (list_size(scene->bodies) > 0) {
+    body_discard(list_remove(scene->bodies, list_size(scene->bodies) - 1));
+  }
+  while (list_size(scene->static_bodies) > 0) {
+    body_discard(list_remove(scene->static_bodies,
+                             list_size(scene->static_bodies) - 1));
+  }
+  scene->statics_removed = false;
+  scene->dead_forces = 0;
+}
+
+// removes and frees all dead forces in one pass, keeping the rest in order
+static void sweep_forces(scene_t *scene) {
+  if (scene->dead_forces == 0) {
+    return;
+  }
+  size_t kept = 0;
   for (size_t i = 0; i < list_size(scene->forces); i++) {
+    force_t *force = list_get(scene->forces, i);
+    if (!force->dead) {
+      list_set(scene->forces, kept++, force);
+      continue;
+    }
+    if (force->collision) {
+      pair_remove_force(scene, force);
+    }
+    force_free(force);
+    STATS_ADD(STAT_FORCES_FREED, 1);
+  }
+  while (list_size(scene->forces) > kept) {
+    list_remove(scene->forces, list_size(scene->forces) - 1);
+  }
+  scene->dead_forces = 0;
+}
+
+// finds a live collision force by its bodies (in order) and handler
+static force_t *collision_find(scene_t *scene, body_t *body1, body_t *body2,
+                               collision_handler_t handler) {
+  collision_pair_t *pair = pair_find(scene, body1, body2);
+  if (pair == NULL) {
+    return NULL;
+  }
+  for (size_t i = 0; i < list_size(pair->forces); i++) {
+    force_t *force = list_get(pair->forces, i);
+    aux_generic_t *aux = force->aux;
+    if (!force->dead && aux_generic_get_body1(aux) == body1 &&
+        aux_generic_get_handler(aux) == handler) {
+      return force;
+    }
+  }
+  return NULL;
+}
+
+bool scene_has_collision(scene_t *scene, body_t *body1, body_t *body2,
+                         collision_handler_t handler) {
+  return collision_find(scene, body1, body2, handler) != NULL;
+}
+
+bool scene_remove_collision(scene_t *scene, body_t *body1, body_t *body2,
+                            collision_handler_t handler) {
+  force_t *force = collision_find(scene, body1, body2, handler);
+  if (force == NULL) {
+    return false;
+  }
+  // freed by the next sweep, so handlers can remove collisions mid-tick
+  force_kill(force);
+  return true;
+}
+
+void scene_set_thread_pool(scene_t *scene, thread_pool_t *threads) {
+  scene->threads = threads;
+}
+
+thread_pool_t *scene_get_thread_pool(scene_t *scene) { return scene->threads; }
+
+// picks how many pieces to split some forces or bodies into
+static size_t scene_chunks(scene_t *scene, size_t count, size_t min_chunk) {
+  if (scene->threads == NULL) {
+    return 1;
+  }
+  size_t max_chunks = thread_pool_threads(scene->threads) * CHUNKS_PER_THREAD;
+  size_t chunks = count / min_chunk;
+  return chunks < 1 ? 1 : chunks > max_chunks ? max_chunks : chunks;
+}
+
+#if STATS
+// the counter for calls to a force creator
+static stat_t force_stat(force_creator_t forcer) {
+  if (forcer == gravity_creator || forcer == gravity_field_creator) {
+    return STAT_GRAVITY_FORCES;
+  }
+  if (forcer == spring_creator) {
+    return STAT_SPRING_FORCES;
+  }
+  if (forcer == drag_creator) {
+    return STAT_DRAG_FORCES;
+  }
+  return STAT_OTHER_FORCES;
+}
+#endif
+
+// calls the force creators from start up to end
+static void run_forces(scene_t *scene, size_t start, size_t end) {
+  for (size_t i = start; i < end; i++) {
     force_t *creator = ((force_t *)list_get(scene->forces, i));
     assert(creator->forcer != NULL);
     assert(creator->aux != NULL);
-    creator->forcer(creator->aux);
+    // collisions only run for bodies the broad phase finds close together
+    if (!creator->collision && !creator->dead) {
+      STATS_ADD(force_stat(creator->forcer), 1);
+      creator->forcer(creator->aux);
+    }
+  }
+}
+
+// calls one piece of the force creators, recording into the piece's own log
+static void force_chunk_job(void *aux, size_t chunk) {
+  scene_t *scene = aux;
+  size_t count = list_size(scene->forces);
+  body_defer_forces(list_get(scene->force_logs, chunk));
+  run_forces(scene, chunk * count / scene->force_chunks,
+             (chunk + 1) * count / scene->force_chunks);
+  body_defer_forces(NULL);
+}
+
+// whether a body is moving slowly enough, with little enough force on it,
+// to count towards putting it to sleep
+static bool body_still(body_t *body) {
+  double mass = body_get_mass(body);
+  double most_force = SLEEP_ACCELERATION * mass;
+  double most_impulse = SLEEP_SPEED * mass;
+  vector_t velocity = body_get_velocity(body);
+  vector_t force = body_get_force(body);
+  vector_t impulse = body_get_impulse(body);
+  return vec_dot(velocity, velocity) <= SLEEP_SPEED * SLEEP_SPEED &&
+         vec_dot(force, force) <= most_force * most_force &&
+         vec_dot(impulse, impulse) <= most_impulse * most_impulse;
+}
+
+// ticks one piece of the bodies; each body only touches itself
+static void body_chunk_job(void *aux, size_t chunk) {
+  scene_t *scene = aux;
+  size_t count = list_size(scene->bodies);
+  size_t end = (chunk + 1) * count / scene->body_chunks;
+  for (size_t i = chunk * count / scene->body_chunks; i < end; i++) {
+    body_t *body = list_get(scene->bodies, i);
+    if (body_is_asleep(body)) {
+      continue;
+    }
+    bool still = SLEEP_TICKS > 0 && body_still(body);
+    body_tick(body, scene->tick_dt);
+    if (!still) {
+      body_set_still_ticks(body, 0);
+      continue;
+    }
+    // nothing can move a body of infinite mass, so it sleeps straight away
+    size_t ticks = body_get_still_ticks(body) + 1;
+    body_set_still_ticks(body, ticks);
+    if (ticks >= SLEEP_TICKS || body_get_mass(body) == INFINITY) {
+      body_sleep(body);
+    }
+  }
+}
+
+// moves a continuous body back to where it first touched a body it has a
+// collision with during the tick, so the next broad phase finds the contact
+// rather than the body having passed through
+static void sweep_continuous(body_t *body) {
+  vector_t start = body_get_interpolated_centroid(body, 0.0);
+  vector_t end = body_get_centroid(body);
+  if (start.x == end.x && start.y == end.y) {
+    return;
+  }
+  double first = INFINITY;
+  list_t *links = body_get_links(body);
+  for (size_t i = 0; i < list_size(links); i++) {
+    force_t *force = ((body_link_t *)list_get(links, i))->owner;
+    if (!force->collision || force->dead) {
+      continue;
+    }
+    body_t *other = aux_generic_get_body1(force->aux);
+    if (other == body) {
+      other = aux_generic_get_body2(force->aux);
+    }
+    if (body_is_removed(other)) {
+      continue;
+    }
+    // bodies touching from the start are already left to the narrow phase
+    double time = find_time_of_impact(body, start, end, other);
+    if (time > 0.0 && time < first) {
+      first = time;
+    }
+  }
+  if (first < 1.0) {
+    body_rewind(body, first);
+  }
+}
+
+// frees removed bodies, keeping the rest in order
+static void sweep_bodies(list_t *bodies) {
+  size_t kept = 0;
+  for (size_t i = 0; i < list_size(bodies); i++) {
+    body_t *body = list_get(bodies, i);
+    if (!body_is_removed(body)) {
+      list_set(bodies, kept++, body);
+      continue;
+    }
+    body_discard(body);
+    STATS_ADD(STAT_BODIES_REMOVED, 1);
+  }
+  while (list_size(bodies) > kept) {
+    list_remove(bodies, list_size(bodies) - 1);
+  }
+}
+
+void scene_tick(scene_t *scene, double dt) {
+  TRACE_BEGIN(tick_zone, "scene_tick");
+  // drops forces killed since the last tick, e.g. by another scene
+  sweep_forces(scene);
+  // calls forces using appropriate forcer
+  TRACE_BEGIN(forces_zone, "forces");
+  size_t force_count = list_size(scene->forces);
+  scene->force_chunks = scene_chunks(scene, force_count, FORCE_CHUNK_SIZE);
+  if (scene->force_chunks == 1) {
+    run_forces(scene, 0, force_count);
+  } else {
+    while (list_size(scene->force_logs) < scene->force_chunks) {
+      list_add(scene->force_logs, force_log_init());
+    }
+    thread_pool_run(scene->threads, force_chunk_job, scene,
+                    scene->force_chunks);
+    // applying the logs in order adds each force exactly as a serial run would
+    for (size_t i = 0; i < scene->force_chunks; i++) {
+      force_log_apply(list_get(scene->force_logs, i));
+    }
   }
+  TRACE_END(forces_zone);
+  // handlers may add bodies and forces, so collisions stay on this thread
+  TRACE_BEGIN(collisions_zone, "collisions");
+  broad_phase(scene);
+  TRACE_END(collisions_zone);
+  TRACE_BEGIN(integrate_zone, "integrate");
+  scene->tick_dt = dt;
+  scene->body_chunks =
+      scene_chunks(scene, list_size(scene->bodies), BODY_CHUNK_SIZE);
+  if (scene->body_chunks == 1) {
+    body_chunk_job(scene, 0);
+  } else {
+    thread_pool_run(scene->threads, body_chunk_job, scene, scene->body_chunks);
+  }
+  TRACE_END(integrate_zone);
+  // sweeps read where other bodies ended up, so they wait for every body
+  // to be ticked and stay on this thread
+  TRACE_BEGIN(sweep_zone, "continuous");
   for (size_t i = 0; i < list_size(scene->bodies); i++) {
-    body_tick(list_get(scene->bodies, i), dt);
-  }
-  // checks for removal
-  for (size_t i = 0; i < scene_bodies(scene); i++) {
-    body_t *curr_body = (body_t *)(list_get(scene->bodies, i));
-    // if body is flagged for removal
-    if (body_is_removed(curr_body)) {
-      // loop through forces
-      for (size_t j = 0; j < scene_forces(scene); j++) {
-        force_t *curr_force = (force_t *)(list_get(scene->forces, j));
-        list_t *body_list = curr_force->bodies;
-        // loop through bodies list for current force
-        for (size_t k = 0; k < list_size(body_list); k++) {
-          // check if the current body is in the current force's bodies list
-          if ((body_t *)(list_get(body_list, k)) == curr_body) {
-            // if it is, remove & free the force from the scene
-            force_t *tem = (force_t *)(list_remove(scene->forces, j));
-            force_free(tem);
-            j--;
-            break;
-          }
-        }
-      }
-      body_t *temp = (body_t *)list_remove(scene->bodies, i);
-      body_free(temp);
-      i--;
+    body_t *body = list_get(scene->bodies, i);
+    if (body_is_continuous(body) && !body_is_asleep(body)) {
+      sweep_continuous(body);
     }
   }
+  TRACE_END(sweep_zone);
+  TRACE_BEGIN(removal_zone, "removal");
+  sweep_bodies(scene->bodies);
+  if (scene->statics_removed) {
+    sweep_bodies(scene->static_bodies);
+    scene->statics_removed = false;
+  }
+  sweep_forces(scene);
+  TRACE_END(removal_zone);
+  TRACE_END(tick_zone);
 }
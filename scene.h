@@ -3,6 +3,7 @@
 
 #include "body.h"
 #include "list.h"
+#include "threadpool.h"
 
 /**
  * A function called when a collision occurs.
@@ -47,6 +48,8 @@ scene_t *scene_init(void);
 /**
  * Releases memory allocated for a given scene
  * and all the bodies and force creators it contains.
+ * Force creators in other scenes that act on its bodies are removed by
+ * those scenes' next ticks, as if the bodies had been removed.
  *
  * @param scene a pointer to a scene returned from scene_init()
  */
@@ -140,6 +143,43 @@ size_t scene_forces(scene_t *scene);
  */
 body_t *scene_get_body(scene_t *scene, size_t index);
 
+/**
+ * Gets the force creator at a given index in a scene,
+ * in the order the force creators were added.
+ * Asserts that the index is valid.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param index the index of the force creator in the scene (starting at 0)
+ * @return a pointer to the force creator at the given index
+ */
+force_t *scene_get_force(scene_t *scene, size_t index);
+
+/**
+ * Gets the function a force creator calls every tick.
+ *
+ * @param force a pointer to a force creator returned from scene_get_force()
+ * @return the forcer passed to scene_add_bodies_force_creator()
+ */
+force_creator_t force_get_forcer(force_t *force);
+
+/**
+ * Gets the auxiliary value a force creator is called with.
+ *
+ * @param force a pointer to a force creator returned from scene_get_force()
+ * @return the aux value passed to scene_add_bodies_force_creator()
+ */
+void *force_get_aux(force_t *force);
+
+/**
+ * Checks whether a force creator has been removed from its scene,
+ * e.g. because one of its bodies was removed, but not yet freed.
+ * Dead force creators are never called again.
+ *
+ * @param force a pointer to a force creator returned from scene_get_force()
+ * @return whether the force creator is dead
+ */
+bool force_is_dead(force_t *force);
+
 /**
  * Adds a body to a scene.
  *
@@ -162,6 +202,49 @@ void scene_remove_body(scene_t *scene, size_t index);
  */
 void scene_remove_body_fake(scene_t *scene, size_t index);
 
+/**
+ * Adds a static body to a scene, making it static with body_set_static().
+ * Static bodies are kept apart from the bodies scene_get_body() returns and
+ * are never ticked. Collisions with them are found through a bounding volume
+ * hierarchy that is only rebuilt when static bodies gain or lose collisions,
+ * so static geometry costs nothing per tick beyond the moving bodies that
+ * touch it.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body a pointer to the body to add to the scene
+ */
+void scene_add_static_body(scene_t *scene, body_t *body);
+
+/**
+ * Gets the number of static bodies in a scene.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of static bodies added with scene_add_static_body()
+ */
+size_t scene_static_bodies(scene_t *scene);
+
+/**
+ * Gets the static body at a given index in a scene.
+ * Asserts that the index is valid.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param index the index of the static body in the scene (starting at 0)
+ * @return a pointer to the static body at the given index
+ */
+body_t *scene_get_static_body(scene_t *scene, size_t index);
+
+/**
+ * Marks the static body at a given index for removal, freeing it on the next
+ * call to scene_tick(). A collision handler may also body_remove() the
+ * static body it was called for; static bodies must not be removed any
+ * other way.
+ * Asserts that the index is valid.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param index the index of the static body in the scene (starting at 0)
+ */
+void scene_remove_static_body(scene_t *scene, size_t index);
+
 /**
  * Adds a force creator to a scene,
  * to be invoked every time scene_tick() is called.
@@ -194,10 +277,121 @@ void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies,
                                     free_func_t freer);
 
+/**
+ * Allocates memory for a force creator's auxiliary value from the scene.
+ * Freed values are recycled for later values of a similar size,
+ * so short-lived forces do not call malloc() once the scene has warmed up.
+ * Free the value with pool_free(), e.g. by passing it as the freer to
+ * scene_add_bodies_force_creator(). The memory belongs to the scene,
+ * so the value must be freed before the scene is.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param size the size of the value in bytes
+ * @return a pointer to uninitialized memory for the value
+ */
+void *scene_alloc_aux(scene_t *scene, size_t size);
+
+/**
+ * Removes and frees every body and force creator in a scene,
+ * leaving it empty but keeping its memory to reuse for new ones.
+ * As with scene_free(), force creators in other scenes that act on its
+ * bodies are removed by those scenes' next ticks.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_reset(scene_t *scene);
+
+/**
+ * Checks whether a scene has a collision registered with create_collision()
+ * between two bodies, in the given order, with the given handler.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 the first body passed to create_collision()
+ * @param body2 the second body passed to create_collision()
+ * @param handler the handler passed to create_collision()
+ * @return whether such a collision is registered
+ */
+bool scene_has_collision(scene_t *scene, body_t *body1, body_t *body2,
+                         collision_handler_t handler);
+
+/**
+ * Removes a collision registered with create_collision() from a scene.
+ * The handler is not called again; its aux value is freed
+ * at the end of the current or next tick.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 the first body passed to create_collision()
+ * @param body2 the second body passed to create_collision()
+ * @param handler the handler passed to create_collision()
+ * @return whether a matching collision was found and removed
+ */
+bool scene_remove_collision(scene_t *scene, body_t *body1, body_t *body2,
+                            collision_handler_t handler);
+
+/**
+ * Sets the side length of the cells in the scene's collision grid.
+ * Collisions registered with create_collision() are only tested between
+ * bodies whose bounding boxes share a cell, so the size should be about
+ * the size of a typical colliding body.
+ * Asserts that the size is positive.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param cell_size the width and height of each grid cell
+ */
+void scene_set_cell_size(scene_t *scene, double cell_size);
+
+/**
+ * Gets the side length of the cells in the scene's collision grid.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the size set with scene_set_cell_size(), or the default
+ */
+double scene_get_cell_size(scene_t *scene);
+
+/**
+ * Sets the threads a scene's ticks are split across.
+ * New scenes use a shared pool of SCENE_THREADS threads, a build flag that
+ * defaults to 1, i.e. no extra threads.
+ * Force creators run in parallel, so they may read any body but must only
+ * change bodies through body_add_force(), body_remove_force() and
+ * body_add_impulse(); those calls are replayed in order afterwards,
+ * so the results are identical to a single-threaded tick.
+ * Only some of a tick is split, and only once there is enough of it:
+ * - force creators, in pieces of at least 32 (collisions are not counted),
+ * - the bodies of a gravity field (see create_gravity_field()), in pieces
+ *   of at least 64,
+ * - and body ticks, in pieces of at least 256.
+ * The collision phase always runs on the calling thread, since handlers
+ * may change any body, so scenes with few forces and bodies, or whose
+ * time goes on collisions, run no faster with more threads.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param threads a pool that outlives the scene, or NULL for no extra threads
+ */
+void scene_set_thread_pool(scene_t *scene, thread_pool_t *threads);
+
+/**
+ * Gets the threads a scene's ticks are split across, so that a force
+ * creator with a lot of work of its own can split it too.
+ * A creator that runs while the pool is busy with the scene's other
+ * creators has its pieces run on its own thread (see thread_pool_run()).
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the pool set with scene_set_thread_pool(), or NULL
+ */
+thread_pool_t *scene_get_thread_pool(scene_t *scene);
+
 /**
  * Executes a tick of a given scene over a small time interval.
  * This requires executing all the force creators
  * and then ticking each body (see body_tick()).
+ * Collision force creators are not called directly; a broad phase grid
+ * finds pairs of bodies that may be touching and only tests those.
+ * With a thread pool set, the force creators and body ticks are split
+ * across its threads; collision handlers always run on the calling thread.
+ * Bodies that have stayed still long enough are put to sleep (see
+ * body_sleep()); they are not ticked, and pairs of sleeping bodies are
+ * not tested for collisions, until something wakes one of them.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param dt the time elapsed since the last tick, in seconds
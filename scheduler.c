@@ -0,0 +1,197 @@
+#include "scheduler.h"
+#include "scene.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct worker {
+  struct scheduler *scheduler;
+  size_t index;
+  pthread_t thread;
+  // the worker's remaining share of the batch, as indices into it.
+  // The worker takes from the front and thieves take from the back.
+  pthread_mutex_t lock;
+  size_t front;
+  size_t back;
+} worker_t;
+
+typedef struct scheduler {
+  size_t num_threads;
+  // one per thread; the caller of scheduler_tick_scenes() is worker 0
+  worker_t *workers;
+  // held for the whole of a batch, so batches from different threads queue
+  pthread_mutex_t run_lock;
+  // guards everything below
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  scene_t **scenes;
+  double dt;
+  size_t ticks;
+  // bumped for every batch, so workers can tell it from a spurious wakeup
+  size_t generation;
+  // threads that have not finished the current batch
+  size_t active;
+  bool stopping;
+} scheduler_t;
+
+// takes the next scene from a worker's own share
+static bool worker_take(worker_t *worker, size_t *index) {
+  pthread_mutex_lock(&worker->lock);
+  bool found = worker->front < worker->back;
+  if (found) {
+    *index = worker->front++;
+  }
+  pthread_mutex_unlock(&worker->lock);
+  return found;
+}
+
+// takes the last scene from another worker's share
+static bool worker_steal(worker_t *victim, size_t *index) {
+  pthread_mutex_lock(&victim->lock);
+  bool found = victim->front < victim->back;
+  if (found) {
+    *index = --victim->back;
+  }
+  pthread_mutex_unlock(&victim->lock);
+  return found;
+}
+
+// ticks scenes until every share is empty; the batch never grows,
+// so a failed pass over all the workers means it is finished
+static void worker_run(worker_t *worker) {
+  scheduler_t *scheduler = worker->scheduler;
+  size_t num_threads = scheduler->num_threads;
+  while (true) {
+    size_t index;
+    bool found = worker_take(worker, &index);
+    for (size_t i = 1; i < num_threads && !found; i++) {
+      found = worker_steal(
+          &scheduler->workers[(worker->index + i) % num_threads], &index);
+    }
+    if (!found) {
+      return;
+    }
+    for (size_t i = 0; i < scheduler->ticks; i++) {
+      scene_tick(scheduler->scenes[index], scheduler->dt);
+    }
+  }
+}
+
+static void *worker_main(void *arg) {
+  worker_t *worker = arg;
+  scheduler_t *scheduler = worker->scheduler;
+  size_t seen = 0;
+  pthread_mutex_lock(&scheduler->lock);
+  while (true) {
+    while (scheduler->generation == seen && !scheduler->stopping) {
+      pthread_cond_wait(&scheduler->start, &scheduler->lock);
+    }
+    if (scheduler->stopping) {
+      break;
+    }
+    seen = scheduler->generation;
+    pthread_mutex_unlock(&scheduler->lock);
+    worker_run(worker);
+    pthread_mutex_lock(&scheduler->lock);
+    if (--scheduler->active == 0) {
+      pthread_cond_signal(&scheduler->done);
+    }
+  }
+  pthread_mutex_unlock(&scheduler->lock);
+  return NULL;
+}
+
+scheduler_t *scheduler_init(size_t threads) {
+  if (threads == 0) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = online > 0 ? (size_t)online : 1;
+  }
+  scheduler_t *scheduler = malloc(sizeof(scheduler_t));
+  assert(scheduler != NULL);
+  scheduler->num_threads = threads;
+  scheduler->workers = malloc(sizeof(worker_t) * threads);
+  assert(scheduler->workers != NULL);
+  pthread_mutex_init(&scheduler->run_lock, NULL);
+  pthread_mutex_init(&scheduler->lock, NULL);
+  pthread_cond_init(&scheduler->start, NULL);
+  pthread_cond_init(&scheduler->done, NULL);
+  scheduler->scenes = NULL;
+  scheduler->dt = 0.0;
+  scheduler->ticks = 0;
+  scheduler->generation = 0;
+  scheduler->active = 0;
+  scheduler->stopping = false;
+  for (size_t i = 0; i < threads; i++) {
+    worker_t *worker = &scheduler->workers[i];
+    worker->scheduler = scheduler;
+    worker->index = i;
+    pthread_mutex_init(&worker->lock, NULL);
+    worker->front = 0;
+    worker->back = 0;
+  }
+  for (size_t i = 1; i < threads; i++) {
+    worker_t *worker = &scheduler->workers[i];
+    int error = pthread_create(&worker->thread, NULL, worker_main, worker);
+    assert(error == 0);
+  }
+  return scheduler;
+}
+
+void scheduler_free(scheduler_t *scheduler) {
+  pthread_mutex_lock(&scheduler->lock);
+  scheduler->stopping = true;
+  pthread_cond_broadcast(&scheduler->start);
+  pthread_mutex_unlock(&scheduler->lock);
+  for (size_t i = 1; i < scheduler->num_threads; i++) {
+    pthread_join(scheduler->workers[i].thread, NULL);
+  }
+  for (size_t i = 0; i < scheduler->num_threads; i++) {
+    pthread_mutex_destroy(&scheduler->workers[i].lock);
+  }
+  pthread_cond_destroy(&scheduler->done);
+  pthread_cond_destroy(&scheduler->start);
+  pthread_mutex_destroy(&scheduler->lock);
+  pthread_mutex_destroy(&scheduler->run_lock);
+  free(scheduler->workers);
+  free(scheduler);
+}
+
+size_t scheduler_threads(scheduler_t *scheduler) {
+  return scheduler->num_threads;
+}
+
+void scheduler_tick_scenes(scheduler_t *scheduler, scene_t **scenes,
+                           size_t count, double dt, size_t ticks) {
+  if (count == 0 || ticks == 0) {
+    return;
+  }
+  pthread_mutex_lock(&scheduler->run_lock);
+  pthread_mutex_lock(&scheduler->lock);
+  scheduler->scenes = scenes;
+  scheduler->dt = dt;
+  scheduler->ticks = ticks;
+  // hands out contiguous shares, so the same batch lands the same way
+  size_t num_threads = scheduler->num_threads;
+  for (size_t i = 0; i < num_threads; i++) {
+    worker_t *worker = &scheduler->workers[i];
+    worker->front = i * count / num_threads;
+    worker->back = (i + 1) * count / num_threads;
+  }
+  scheduler->active = num_threads - 1;
+  scheduler->generation++;
+  pthread_cond_broadcast(&scheduler->start);
+  pthread_mutex_unlock(&scheduler->lock);
+
+  worker_run(&scheduler->workers[0]);
+
+  // the completion barrier: every worker has run out of scenes to steal
+  pthread_mutex_lock(&scheduler->lock);
+  while (scheduler->active > 0) {
+    pthread_cond_wait(&scheduler->done, &scheduler->lock);
+  }
+  pthread_mutex_unlock(&scheduler->lock);
+  pthread_mutex_unlock(&scheduler->run_lock);
+}
@@ -0,0 +1,65 @@
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include "scene.h"
+#include <stddef.h>
+
+/**
+ * A set of worker threads that tick batches of independent scenes.
+ * Each worker starts with its own share of the batch and, once that runs out,
+ * steals scenes from the end of another worker's share, so a few slow scenes
+ * do not leave the other threads idle.
+ * A scene's share is chosen by its position in the batch, so passing the
+ * same batch every time keeps each scene on the same thread (and its cache)
+ * unless it is stolen.
+ *
+ * Scenes in a batch must not share bodies or forces.
+ * Collision handlers run on the worker ticking their scene,
+ * so they must only touch their own scene's state.
+ */
+typedef struct scheduler scheduler_t;
+
+/**
+ * Allocates memory for a scheduler and starts its workers.
+ * Asserts that the required memory is allocated and the threads start.
+ *
+ * @param threads the number of threads to tick scenes on, including the
+ *   caller; 0 means one per online processor
+ * @return a pointer to the newly allocated scheduler
+ */
+scheduler_t *scheduler_init(size_t threads);
+
+/**
+ * Stops a scheduler's workers and releases the memory allocated for it.
+ *
+ * @param scheduler a pointer to a scheduler returned from scheduler_init()
+ */
+void scheduler_free(scheduler_t *scheduler);
+
+/**
+ * Gets the number of threads a scheduler ticks scenes on,
+ * including the caller.
+ *
+ * @param scheduler a pointer to a scheduler returned from scheduler_init()
+ * @return the number of threads
+ */
+size_t scheduler_threads(scheduler_t *scheduler);
+
+/**
+ * Ticks every scene in a batch a number of times, spread across the
+ * scheduler's threads, and waits until all of them are done.
+ * Each scene runs all of its ticks in a row on one thread,
+ * so the results are the same as ticking the scenes one after another.
+ * Batches started from several threads run one at a time,
+ * so this must not be called from inside a scene's tick.
+ *
+ * @param scheduler a pointer to a scheduler returned from scheduler_init()
+ * @param scenes the scenes to tick
+ * @param count the number of scenes
+ * @param dt the time elapsed in each tick, in seconds
+ * @param ticks the number of times to tick each scene
+ */
+void scheduler_tick_scenes(scheduler_t *scheduler, scene_t **scenes,
+                           size_t count, double dt, size_t ticks);
+
+#endif // #ifndef __SCHEDULER_H__
@@ -1,17 +1,33 @@
 #include "sdl_wrapper.h"
+#include "input_stream.h"
+#include "stats.h"
+#include "trace.h"
 #include <SDL2/SDL.h>
-#include <SDL2/SDL2_gfxPrimitives.h>
 #include <SDL2/SDL_image.h>
 #include <assert.h>
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
 
 const char WINDOW_TITLE[] = "CS 3";
 const int WINDOW_WIDTH = 1000;
 const int WINDOW_HEIGHT = 500;
 const double MS_PER_S = 1e3;
 const int white = 255;
+const size_t TEXTURE_BUCKETS = 64;
+const size_t START_BATCH_VERTICES = 1024;
+const size_t CIRCLE_DRAW_POINTS = 40;
+
+/**
+ * A sprite image loaded into a texture, keyed by the path it was loaded from.
+ * The texture is NULL if the image failed to load,
+ * so a missing file is not reloaded every frame.
+ */
+typedef struct texture_entry {
+  char *path;
+  SDL_Texture *texture;
+} texture_entry_t;
 
 /**
  * The coordinate at the center of the screen.
@@ -39,20 +55,58 @@ key_handler_t key_handler = NULL;
  */
 uint32_t key_start_timestamp;
 /**
- * The value of clock() when time_since_last_tick() was last called.
- * Initially 0.
+ * The value of SDL_GetPerformanceCounter() when time_since_last_tick()
+ * last measured the time. Initially 0.
+ */
+uint64_t last_counter = 0;
+/**
+ * If positive, the dt returned by time_since_last_tick() instead of the
+ * measured time. See sdl_set_fixed_dt().
+ */
+double fixed_dt = 0.0;
+/**
+ * Whether the drawing functions draw anything. See sdl_set_rendering().
+ */
+bool rendering = true;
+/**
+ * How far between their last two ticks bodies are drawn.
+ */
+double interpolation = 1.0;
+/**
+ * The sprite cache: TEXTURE_BUCKETS lists of texture_entry_t, hashed by path.
+ * Allocated the first time a sprite is loaded.
+ */
+list_t **textures = NULL;
+/**
+ * Polygons waiting to be drawn, as triangles in window coordinates.
+ * Each polygon is split into a fan around the average of its vertices.
+ * The buffers are reused between frames and only grow.
+ */
+SDL_Vertex *batch_vertices = NULL;
+size_t batch_num_vertices = 0;
+size_t batch_vertex_capacity = 0;
+int *batch_indices = NULL;
+size_t batch_num_indices = 0;
+size_t batch_index_capacity = 0;
+/**
+ * Space for the vertices passed to sdl_draw_polygon() and for circle outlines.
  */
-clock_t last_clock = 0;
+vector_t *scratch_points = NULL;
+size_t scratch_capacity = 0;
+/**
+ * The file input is being recorded to, or NULL if not recording.
+ * See sdl_record_input() and input_stream.h.
+ */
+FILE *recording = NULL;
+
+_Static_assert(SDL_NUM_SCANCODES <= INPUT_STREAM_KEYS,
+               "every scancode fits in a recording");
 
 /** Computes the center of the window in pixel coordinates */
 vector_t get_window_center(void) {
-  int *width = malloc(sizeof(*width)), *height = malloc(sizeof(*height));
-  assert(width != NULL);
-  assert(height != NULL);
-  SDL_GetWindowSize(window, width, height);
-  vector_t dimensions = {.x = *width, .y = *height};
-  free(width);
-  free(height);
+  int width, height;
+  SDL_GetWindowSize(window, &width, &height);
+  vector_t dimensions = {.x = width, .y = height};
   return vec_multiply(0.5, dimensions);
 }
 
@@ -116,13 +170,62 @@ void sdl_init(vector_t min, vector_t max) {
   renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
 }
 
+/** Appends bytes to the recording */
+static void record_write(const void *data, size_t size) {
+  size_t written = fwrite(data, size, 1, recording);
+  assert(written == 1);
+}
+
+static void record_tag(input_record_t tag) {
+  uint8_t byte = tag;
+  record_write(&byte, sizeof(byte));
+}
+
+/** Records a key event as the keys that were down when it happened */
+static void record_key(const uint8_t *keys, key_event_type_t type,
+                       double held_time) {
+  uint16_t down[INPUT_STREAM_KEYS];
+  uint16_t count = 0;
+  for (uint16_t i = 0; i < SDL_NUM_SCANCODES; i++) {
+    if (keys[i]) {
+      down[count++] = i;
+    }
+  }
+  uint8_t event_type = type;
+  record_tag(INPUT_KEY);
+  record_write(&event_type, sizeof(event_type));
+  record_write(&held_time, sizeof(held_time));
+  record_write(&count, sizeof(count));
+  if (count > 0) {
+    record_write(down, sizeof(uint16_t) * count);
+  }
+}
+
+void sdl_record_input(const char *path) {
+  if (recording != NULL) {
+    fclose(recording);
+    recording = NULL;
+  }
+  if (path == NULL) {
+    return;
+  }
+  recording = fopen(path, "wb");
+  assert(recording != NULL);
+  uint32_t version = INPUT_STREAM_VERSION;
+  record_write(INPUT_STREAM_MAGIC, strlen(INPUT_STREAM_MAGIC));
+  record_write(&version, sizeof(version));
+}
+
 bool sdl_is_done(state_t *state) {
-  SDL_Event *event = malloc(sizeof(*event));
-  assert(event != NULL);
+  SDL_Event event_storage;
+  SDL_Event *event = &event_storage;
   while (SDL_PollEvent(event)) {
     switch (event->type) {
     case SDL_QUIT:
-      free(event);
+      if (recording != NULL) {
+        record_tag(INPUT_QUIT);
+        sdl_record_input(NULL);
+      }
       return true;
     case SDL_KEYDOWN:
     case SDL_KEYUP:
@@ -142,57 +245,241 @@ bool sdl_is_done(state_t *state) {
       key_event_type_t type =
           event->type == SDL_KEYDOWN ? KEY_PRESSED : KEY_RELEASED;
       double held_time = (timestamp - key_start_timestamp) / MS_PER_S;
+      if (recording != NULL) {
+        record_key(temp, type, held_time);
+      }
       key_handler(temp, type, held_time, state);
       break;
     }
   }
-  free(event);
+  if (recording != NULL) {
+    record_tag(INPUT_POLL);
+  }
   return false;
 }
 
-void sdl_clear(void) {
-  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
-  SDL_RenderClear(renderer);
+/** Draws and empties the polygon batch */
+static void batch_flush(void) {
+  if (batch_num_indices > 0) {
+    SDL_RenderGeometry(renderer, NULL, batch_vertices, batch_num_vertices,
+                       batch_indices, batch_num_indices);
+  }
+  batch_num_vertices = 0;
+  batch_num_indices = 0;
 }
 
-void sdl_draw_polygon(list_t *points, rgb_color_t color) {
-  // Check parameters
-  size_t n = list_size(points);
+/** Grows the batch buffers to fit a polygon with n more vertices */
+static void batch_reserve(size_t n) {
+  // one extra vertex for the center of the fan, and three indices per edge
+  size_t vertices = batch_num_vertices + n + 1;
+  size_t indices = batch_num_indices + 3 * n;
+  if (vertices > batch_vertex_capacity) {
+    batch_vertex_capacity = batch_vertex_capacity > 0
+                                ? batch_vertex_capacity
+                                : START_BATCH_VERTICES;
+    while (vertices > batch_vertex_capacity) {
+      batch_vertex_capacity *= 2;
+    }
+    batch_vertices = realloc(batch_vertices,
+                             sizeof(SDL_Vertex) * batch_vertex_capacity);
+    assert(batch_vertices != NULL);
+  }
+  if (indices > batch_index_capacity) {
+    batch_index_capacity =
+        batch_index_capacity > 0 ? batch_index_capacity : START_BATCH_VERTICES;
+    while (indices > batch_index_capacity) {
+      batch_index_capacity *= 2;
+    }
+    batch_indices = realloc(batch_indices, sizeof(int) * batch_index_capacity);
+    assert(batch_indices != NULL);
+  }
+}
+
+/**
+ * Adds a polygon to the batch. The polygon is drawn as a fan of triangles
+ * around the average of its vertices, which covers it exactly as long as
+ * every vertex is visible from that point (true of convex polygons and of
+ * the star and pacman shapes in the demos).
+ */
+static void batch_polygon(const vector_t *points, size_t n,
+                          rgb_color_t color, vector_t shift,
+                          vector_t window_center) {
   assert(n >= 3);
   assert(0 <= color.r && color.r <= 1);
   assert(0 <= color.g && color.g <= 1);
   assert(0 <= color.b && color.b <= 1);
+  STATS_ADD(STAT_POLYGONS_DRAWN, 1);
+  STATS_ADD(STAT_VERTICES_DRAWN, n);
+  batch_reserve(n);
 
-  vector_t window_center = get_window_center();
+  SDL_Color fill = {.r = color.r * white,
+                    .g = color.g * white,
+                    .b = color.b * white,
+                    .a = white};
+  // same mapping as get_window_position(), with the scale computed once
+  double scale = get_scene_scale(window_center);
+  vector_t origin = vec_subtract(center, shift);
+  size_t first = batch_num_vertices;
+  vector_t sum = VEC_ZERO;
+  for (size_t i = 0; i < n; i++) {
+    vector_t offset = vec_multiply(scale, vec_subtract(points[i], origin));
+    vector_t pixel = {.x = round(window_center.x + offset.x),
+                      .y = round(window_center.y - offset.y)};
+    sum = vec_add(sum, pixel);
+    batch_vertices[first + 1 + i] = (SDL_Vertex){
+        .position = {.x = pixel.x, .y = pixel.y}, .color = fill};
+  }
+  vector_t mid = vec_multiply(1.0 / n, sum);
+  batch_vertices[first] =
+      (SDL_Vertex){.position = {.x = mid.x, .y = mid.y}, .color = fill};
 
-  // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points != NULL);
-  assert(y_points != NULL);
+  int *indices = &batch_indices[batch_num_indices];
   for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = list_get(points, i);
-    vector_t pixel = get_window_position(*vertex, window_center);
-    x_points[i] = pixel.x;
-    y_points[i] = pixel.y;
+    indices[3 * i] = first;
+    indices[3 * i + 1] = first + 1 + i;
+    indices[3 * i + 2] = first + 1 + (i + 1) % n;
   }
+  batch_num_vertices += n + 1;
+  batch_num_indices += 3 * n;
+}
 
-  // Draw polygon with the given color
-  filledPolygonRGBA(renderer, x_points, y_points, n, color.r * white,
-                    color.g * white, color.b * white, white);
-  free(x_points);
-  free(y_points);
+void sdl_clear(void) {
+  if (!rendering) {
+    return;
+  }
+  // anything still batched would be cleared anyway
+  batch_num_vertices = 0;
+  batch_num_indices = 0;
+  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+  SDL_RenderClear(renderer);
 }
 
-void sdl_draw_sprite(char *im_path, vector_t center, vector_t dim) {
-  // variable declarations
-  SDL_Texture *img = NULL;
+/** Makes room for n points in the scratch buffer */
+static void scratch_reserve(size_t n) {
+  if (n > scratch_capacity) {
+    scratch_capacity = n;
+    scratch_points = realloc(scratch_points, sizeof(vector_t) * n);
+    assert(scratch_points != NULL);
+  }
+}
 
-  // load our image
-  img = IMG_LoadTexture(renderer, im_path);
-  // get the width and height of the texture
+void sdl_draw_polygon(list_t *points, rgb_color_t color) {
+  if (!rendering) {
+    return;
+  }
+  TRACE_BEGIN(zone, "sdl_draw_polygon");
+  // packs the list into a reused buffer so it can be batched like vertices
+  size_t n = list_size(points);
+  scratch_reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    scratch_points[i] = *(vector_t *)list_get(points, i);
+  }
+  batch_polygon(scratch_points, n, color, VEC_ZERO, get_window_center());
+  TRACE_END(zone);
+}
+
+void sdl_draw_vertices(vertices_t points, rgb_color_t color) {
+  if (!rendering) {
+    return;
+  }
+  batch_polygon(points.data, points.size, color, VEC_ZERO,
+                get_window_center());
+}
+
+/** Gets how far to move a body from its current position to draw it */
+static vector_t get_body_shift(body_t *body) {
+  return vec_subtract(body_get_interpolated_centroid(body, interpolation),
+                      body_get_centroid(body));
+}
+
+/**
+ * Adds a body to the batch.
+ * Circles are drawn from their radius, so they never need vertices.
+ */
+static void batch_body(body_t *body, vector_t window_center) {
+  if (body_get_shape_kind(body) == SHAPE_CIRCLE) {
+    scratch_reserve(CIRCLE_DRAW_POINTS);
+    vector_t center = body_get_centroid(body);
+    double radius = body_get_radius(body);
+    double arc_angle = 2 * M_PI / CIRCLE_DRAW_POINTS;
+    for (size_t i = 0; i < CIRCLE_DRAW_POINTS; i++) {
+      scratch_points[i] =
+          (vector_t){.x = center.x + radius * cos(i * arc_angle),
+                     .y = center.y + radius * sin(i * arc_angle)};
+    }
+    batch_polygon(scratch_points, CIRCLE_DRAW_POINTS, body_get_color(body),
+                  get_body_shift(body), window_center);
+    return;
+  }
+  vertices_t vertices = body_get_vertices(body);
+  batch_polygon(vertices.data, vertices.size, body_get_color(body),
+                get_body_shift(body), window_center);
+}
+
+void sdl_draw_body(body_t *body) {
+  if (!rendering) {
+    return;
+  }
+  TRACE_BEGIN(zone, "sdl_draw_body");
+  batch_body(body, get_window_center());
+  TRACE_END(zone);
+}
+
+static void texture_entry_free(texture_entry_t *entry) {
+  if (entry->texture != NULL) {
+    SDL_DestroyTexture(entry->texture);
+  }
+  free(entry->path);
+  free(entry);
+}
+
+static size_t texture_hash(const char *path) {
+  // djb2
+  size_t hash = 5381;
+  for (const char *c = path; *c != '\0'; c++) {
+    hash = hash * 33 + (unsigned char)*c;
+  }
+  return hash % TEXTURE_BUCKETS;
+}
+
+/** Finds the cache entry for a path, loading the image if it is not cached */
+static texture_entry_t *get_texture(const char *path) {
+  if (textures == NULL) {
+    textures = malloc(sizeof(list_t *) * TEXTURE_BUCKETS);
+    assert(textures != NULL);
+    for (size_t i = 0; i < TEXTURE_BUCKETS; i++) {
+      textures[i] = list_init(0, (free_func_t)texture_entry_free);
+    }
+  }
+  list_t *bucket = textures[texture_hash(path)];
+  for (size_t i = 0; i < list_size(bucket); i++) {
+    texture_entry_t *entry = list_get(bucket, i);
+    if (strcmp(entry->path, path) == 0) {
+      return entry;
+    }
+  }
+
+  texture_entry_t *entry = malloc(sizeof(texture_entry_t));
+  assert(entry != NULL);
+  entry->path = malloc(strlen(path) + 1);
+  assert(entry->path != NULL);
+  strcpy(entry->path, path);
+  entry->texture = IMG_LoadTexture(renderer, path);
+  list_add(bucket, entry);
+  return entry;
+}
+
+void sdl_draw_sprite(const char *im_path, vector_t center, vector_t dim) {
+  if (!rendering) {
+    return;
+  }
+  // keeps sprites in front of the polygons drawn before them
+  batch_flush();
+  SDL_Texture *img = get_texture(im_path)->texture;
+  if (img == NULL) {
+    return;
+  }
   // put the location where we want the texture to be drawn into a rectangle
-  // I'm also scaling the texture 2x simply by setting the width and height
   SDL_Rect texr = {center.x - (dim.x / 2), center.y - (dim.y / 2), dim.x,
                    dim.y};
 
@@ -200,33 +487,73 @@ void sdl_draw_sprite(char *im_path, vector_t center, vector_t dim) {
   SDL_RenderCopy(renderer, img, NULL, &texr);
 }
 
+bool sdl_preload_sprite(const char *im_path) {
+  return get_texture(im_path)->texture != NULL;
+}
+
+void sdl_evict_sprite(const char *im_path) {
+  if (textures == NULL) {
+    return;
+  }
+  list_t *bucket = textures[texture_hash(im_path)];
+  for (size_t i = 0; i < list_size(bucket); i++) {
+    texture_entry_t *entry = list_get(bucket, i);
+    if (strcmp(entry->path, im_path) == 0) {
+      texture_entry_free(list_swap_remove(bucket, i));
+      return;
+    }
+  }
+}
+
+void sdl_evict_all_sprites(void) {
+  if (textures == NULL) {
+    return;
+  }
+  for (size_t i = 0; i < TEXTURE_BUCKETS; i++) {
+    list_free(textures[i]);
+  }
+  free(textures);
+  textures = NULL;
+}
+
 void sdl_show(void) {
+  if (!rendering) {
+    return;
+  }
+  TRACE_BEGIN(zone, "sdl_show");
+  batch_flush();
+
   // Draw boundary lines
   vector_t window_center = get_window_center();
   vector_t max = vec_add(center, max_diff),
            min = vec_subtract(center, max_diff);
   vector_t max_pixel = get_window_position(max, window_center),
            min_pixel = get_window_position(min, window_center);
-  SDL_Rect *boundary = malloc(sizeof(*boundary));
-  boundary->x = min_pixel.x;
-  boundary->y = max_pixel.y;
-  boundary->w = max_pixel.x - min_pixel.x;
-  boundary->h = min_pixel.y - max_pixel.y;
+  SDL_Rect boundary = {.x = min_pixel.x,
+                       .y = max_pixel.y,
+                       .w = max_pixel.x - min_pixel.x,
+                       .h = min_pixel.y - max_pixel.y};
   SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-  SDL_RenderDrawRect(renderer, boundary);
-  free(boundary);
+  SDL_RenderDrawRect(renderer, &boundary);
 
   SDL_RenderPresent(renderer);
+  TRACE_END(zone);
 }
 
 void sdl_render_scene(scene_t *scene) {
+  if (!rendering) {
+    return;
+  }
   sdl_clear();
+  // every body goes into one batch, drawn by sdl_show()
+  vector_t window_center = get_window_center();
   size_t body_count = scene_bodies(scene);
   for (size_t i = 0; i < body_count; i++) {
-    body_t *body = scene_get_body(scene, i);
-    list_t *shape = body_get_shape(body);
-    sdl_draw_polygon(shape, body_get_color(body));
-    list_free(shape);
+    batch_body(scene_get_body(scene, i), window_center);
+  }
+  size_t static_count = scene_static_bodies(scene);
+  for (size_t i = 0; i < static_count; i++) {
+    batch_body(scene_get_static_body(scene, i), window_center);
   }
 
   sdl_show();
@@ -235,10 +562,42 @@ void sdl_render_scene(scene_t *scene) {
 void sdl_on_key(key_handler_t handler) { key_handler = handler; }
 
 double time_since_last_tick(void) {
-  clock_t now = clock();
-  double difference = last_clock
-                          ? (double)(now - last_clock) / CLOCKS_PER_SEC
-                          : 0.0; // return 0 the first time this is called
-  last_clock = now;
+  if (fixed_dt > 0.0) {
+    return fixed_dt;
+  }
+  // measures wall-clock time, which keeps counting while vsync waits
+  uint64_t now = SDL_GetPerformanceCounter();
+  double difference =
+      last_counter
+          ? (double)(now - last_counter) / SDL_GetPerformanceFrequency()
+          : 0.0; // return 0 the first time this is called
+  last_counter = now;
+  if (recording != NULL) {
+    record_tag(INPUT_TIME);
+    record_write(&difference, sizeof(difference));
+  }
   return difference;
 }
+
+void sdl_set_fixed_dt(double dt) {
+  assert(dt >= 0.0);
+  fixed_dt = dt;
+}
+
+void sdl_set_rendering(bool enabled) { rendering = enabled; }
+
+void sdl_set_interpolation(double alpha) {
+  assert(0.0 <= alpha && alpha <= 1.0);
+  interpolation = alpha;
+}
+
+double sdl_get_interpolation(void) { return interpolation; }
+
+void sdl_wait(double seconds) {
+#ifndef __EMSCRIPTEN__
+  // rounds up, since waking early would only spin until the time is up
+  if (seconds > 0.0) {
+    SDL_Delay((Uint32)ceil(seconds * 1000));
+  }
+#endif
+}
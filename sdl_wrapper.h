@@ -3,6 +3,7 @@
 
 #include "color.h"
 #include "list.h"
+#include "polygon.h"
 #include "scene.h"
 #include "state.h"
 #include "vector.h"
@@ -70,7 +71,56 @@ void sdl_clear(void);
  */
 void sdl_draw_polygon(list_t *points, rgb_color_t color);
 
-void sdl_draw_sprite(char *im_path, vector_t center, vector_t dim);
+/**
+ * Draws a polygon from a packed array of vertices and a color.
+ * Behaves like sdl_draw_polygon(); use this for body_get_vertices().
+ *
+ * @param points the vertices of the polygon
+ * @param color the color used to fill in the polygon
+ */
+void sdl_draw_vertices(vertices_t points, rgb_color_t color);
+
+/**
+ * Draws a body in its color, interpolated between its last two ticks
+ * according to sdl_get_interpolation().
+ *
+ * @param body the body to draw
+ */
+void sdl_draw_body(body_t *body);
+
+/**
+ * Draws an image centered at a pixel position, scaled to the given size.
+ * The image is loaded the first time its path is drawn or preloaded and is
+ * cached by path afterwards, so drawing it again does not reload the file.
+ *
+ * @param im_path the path of the image file
+ * @param center the pixel coordinates of the center of the image
+ * @param dim the width and height of the image in pixels
+ */
+void sdl_draw_sprite(const char *im_path, vector_t center, vector_t dim);
+
+/**
+ * Loads an image into the sprite cache without drawing it,
+ * e.g. to avoid a pause the first time a sprite is drawn.
+ * Does nothing if the image is already cached.
+ *
+ * @param im_path the path of the image file
+ * @return whether the image was loaded successfully
+ */
+bool sdl_preload_sprite(const char *im_path);
+
+/**
+ * Removes an image from the sprite cache and frees its texture.
+ * Does nothing if the image is not cached.
+ *
+ * @param im_path the path of the image file
+ */
+void sdl_evict_sprite(const char *im_path);
+
+/**
+ * Removes every image from the sprite cache and frees their textures.
+ */
+void sdl_evict_all_sprites(void);
 
 /**
  * Displays the rendered frame on the SDL window.
@@ -80,7 +130,7 @@ void sdl_show(void);
 
 /**
  * Draws all bodies in a scene.
- * This internally calls sdl_clear(), sdl_draw_polygon(), and sdl_show(),
+ * This internally calls sdl_clear(), sdl_draw_body(), and sdl_show(),
  * so those functions should not be called directly.
  *
  * @param scene the scene to draw
@@ -123,4 +173,59 @@ void sdl_on_key(key_handler_t handler);
  */
 double time_since_last_tick(void);
 
+/**
+ * Makes time_since_last_tick() return a fixed dt instead of measuring time,
+ * so a frame loop can run several fixed physics steps in one frame.
+ * The time measured by the next unfixed call still covers the whole frame.
+ *
+ * @param dt the dt to return, or 0 to measure real time again
+ */
+void sdl_set_fixed_dt(double dt);
+
+/**
+ * Starts recording the demo's input to a file: every key event passed to
+ * the key handler and every dt measured by time_since_last_tick(),
+ * in the order the demo saw them. Playing the file back with replay.c
+ * reruns the session exactly, without a window.
+ * The file is closed when the window is closed or recording is stopped.
+ * Asserts that the file can be opened.
+ *
+ * @param path the file to record to, or NULL to stop recording
+ */
+void sdl_record_input(const char *path);
+
+/**
+ * Turns drawing on or off. While drawing is off, sdl_clear(), sdl_show()
+ * and the sdl_draw_* and sdl_render_scene() functions do nothing,
+ * so a frame loop can tick a demo several times but only draw it once.
+ *
+ * @param enabled whether to draw
+ */
+void sdl_set_rendering(bool enabled);
+
+/**
+ * Sets how far between the last two ticks bodies are drawn,
+ * from 0 (their positions before the last tick) to 1 (their current
+ * positions, the default). See body_get_interpolated_centroid().
+ *
+ * @param alpha the fraction of the last tick to draw
+ */
+void sdl_set_interpolation(double alpha);
+
+/**
+ * Gets the fraction of the last tick that bodies are drawn at.
+ *
+ * @return the value last passed to sdl_set_interpolation(), or 1
+ */
+double sdl_get_interpolation(void);
+
+/**
+ * Waits for some time to pass, so a frame loop with nothing to do yet does
+ * not spin. Does nothing in the browser, which already calls the loop once
+ * per display frame, or when replaying a recording (see replay.c).
+ *
+ * @param seconds how long to wait
+ */
+void sdl_wait(double seconds);
+
 #endif // #ifndef __SDL_WRAPPER_H__
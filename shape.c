@@ -0,0 +1,102 @@
+#include "shape.h"
+#include "list.h"
+#include "polygon.h"
+#include "vector.h"
+#include <assert.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+typedef struct shape {
+  shape_kind_t kind;
+  // only used by circles
+  double radius;
+  // relative to the centroid, with their edge normals
+  vertices_t vertices;
+  // bodies may be freed on different threads, so the count is atomic
+  atomic_size_t references;
+} shape_t;
+
+const size_t CIRCLE_VERTICES = 40;
+
+shape_t *shape_init_vertices(vertices_t vertices, shape_kind_t kind) {
+  assert(kind != SHAPE_BOX || vertices.size == 4);
+  shape_t *shape = malloc(sizeof(shape_t));
+  assert(shape != NULL);
+  shape->kind = kind;
+  shape->radius = 0.0;
+  shape->vertices = vertices;
+  // edge normals only change when a body turns, so they are worked out once
+  // here and rotated along with the vertices
+  size_t size = vertices.size > 0 ? vertices.size : 1;
+  shape->vertices.normals = malloc(sizeof(vector_t) * size);
+  assert(shape->vertices.normals != NULL);
+  vertices_edge_normals(shape->vertices, shape->vertices.normals);
+  atomic_init(&shape->references, 1);
+  return shape;
+}
+
+shape_t *shape_init(list_t *points) {
+  // packs the shape so the vertices are contiguous, then drops the list
+  vertices_t vertices = vertices_from_list(points);
+  list_free(points);
+  vertices_translate(vertices, vec_negate(vertices_centroid(vertices)));
+  return shape_init_vertices(vertices, SHAPE_POLYGON);
+}
+
+shape_t *shape_init_box(double width, double height) {
+  assert(width > 0.0 && height > 0.0);
+  // counterclockwise from the top right corner
+  vector_t *corners = malloc(sizeof(vector_t) * 4);
+  assert(corners != NULL);
+  double half_width = width / 2;
+  double half_height = height / 2;
+  corners[0] = (vector_t){half_width, half_height};
+  corners[1] = (vector_t){-half_width, half_height};
+  corners[2] = (vector_t){-half_width, -half_height};
+  corners[3] = (vector_t){half_width, -half_height};
+  return shape_init_vertices(
+      (vertices_t){.data = corners, .size = 4, .normals = NULL}, SHAPE_BOX);
+}
+
+shape_t *shape_init_circle(double radius) {
+  assert(radius > 0.0);
+  vector_t *points = malloc(sizeof(vector_t) * CIRCLE_VERTICES);
+  assert(points != NULL);
+  double arc_angle = 2 * M_PI / CIRCLE_VERTICES;
+  for (size_t i = 0; i < CIRCLE_VERTICES; i++) {
+    points[i] = (vector_t){.x = radius * cos(i * arc_angle),
+                           .y = radius * sin(i * arc_angle)};
+  }
+  shape_t *shape = shape_init_vertices(
+      (vertices_t){.data = points, .size = CIRCLE_VERTICES, .normals = NULL},
+      SHAPE_POLYGON);
+  shape->kind = SHAPE_CIRCLE;
+  shape->radius = radius;
+  return shape;
+}
+
+shape_t *shape_retain(shape_t *shape) {
+  // taking a reference needs no ordering, since the caller already has one
+  atomic_fetch_add_explicit(&shape->references, 1, memory_order_relaxed);
+  return shape;
+}
+
+void shape_release(shape_t *shape) {
+  if (atomic_fetch_sub_explicit(&shape->references, 1,
+                                memory_order_acq_rel) != 1) {
+    return;
+  }
+  free(shape->vertices.data);
+  free(shape->vertices.normals);
+  free(shape);
+}
+
+shape_kind_t shape_get_kind(shape_t *shape) { return shape->kind; }
+
+double shape_get_radius(shape_t *shape) {
+  assert(shape->kind == SHAPE_CIRCLE);
+  return shape->radius;
+}
+
+vertices_t shape_get_vertices(shape_t *shape) { return shape->vertices; }
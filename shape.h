@@ -0,0 +1,120 @@
+#ifndef __SHAPE_H__
+#define __SHAPE_H__
+
+#include "list.h"
+#include "polygon.h"
+#include <stddef.h>
+
+/**
+ * The kind of shape a body has.
+ * Circles and axis-aligned boxes are common enough that collision.c tests
+ * them analytically instead of running SAT over their vertices.
+ */
+typedef enum {
+  /** A convex polygon, described by its vertices */
+  SHAPE_POLYGON,
+  /** A circle, described by its centroid and radius */
+  SHAPE_CIRCLE,
+  /** An axis-aligned rectangle, stored as four vertices */
+  SHAPE_BOX
+} shape_kind_t;
+
+/**
+ * A shape in its own frame, with its centroid at the origin.
+ * A shape never changes once created, so any number of bodies can share it,
+ * each with its own position and angle; see body_init_shared().
+ *
+ * Shapes are reference counted. Whoever creates a shape holds one reference
+ * and each body using it holds another, so the creator may release its
+ * reference as soon as the bodies have been created. References may be
+ * taken and released from any thread.
+ */
+typedef struct shape shape_t;
+
+/**
+ * The number of vertices in the regular polygon that stands in for a circle.
+ */
+extern const size_t CIRCLE_VERTICES;
+
+/**
+ * Creates a convex polygon shape.
+ * The polygon is moved so that its centroid is at the origin.
+ *
+ * @param points the polygon's vertices in counterclockwise order,
+ *   which the shape takes ownership of and frees
+ * @return the shape, holding one reference
+ */
+shape_t *shape_init(list_t *points);
+
+/**
+ * Creates a convex polygon shape from vertices already around the origin.
+ * Unlike shape_init(), the vertices are used exactly as given.
+ *
+ * @param vertices the polygon's vertices relative to its centroid,
+ *   which must be malloc()ed; the shape takes ownership of the array
+ * @param kind SHAPE_POLYGON, or SHAPE_BOX if the vertices are the corners
+ *   of an axis-aligned rectangle centered on the origin
+ * @return the shape, holding one reference
+ */
+shape_t *shape_init_vertices(vertices_t vertices, shape_kind_t kind);
+
+/**
+ * Creates an axis-aligned rectangle shape centered on the origin.
+ *
+ * @param width the size of the rectangle along the x-axis
+ * @param height the size of the rectangle along the y-axis
+ * @return the shape, holding one reference
+ */
+shape_t *shape_init_box(double width, double height);
+
+/**
+ * Creates a circle shape centered on the origin, along with the
+ * CIRCLE_VERTICES-sided polygon used when its vertices are needed.
+ *
+ * @param radius the radius of the circle
+ * @return the shape, holding one reference
+ */
+shape_t *shape_init_circle(double radius);
+
+/**
+ * Takes another reference to a shape.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @return the same shape
+ */
+shape_t *shape_retain(shape_t *shape);
+
+/**
+ * Releases a reference to a shape, freeing it when none are left.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ */
+void shape_release(shape_t *shape);
+
+/**
+ * Gets the kind of a shape.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @return SHAPE_POLYGON, SHAPE_CIRCLE or SHAPE_BOX
+ */
+shape_kind_t shape_get_kind(shape_t *shape);
+
+/**
+ * Gets the radius of a circle shape.
+ *
+ * @param shape a pointer to a shape returned from shape_init_circle()
+ * @return the radius of the circle
+ */
+double shape_get_radius(shape_t *shape);
+
+/**
+ * Gets the vertices of a shape, relative to its centroid,
+ * along with their edge normals.
+ * The array is owned by the shape and must not be changed.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @return the shape's vertices
+ */
+vertices_t shape_get_vertices(shape_t *shape);
+
+#endif // #ifndef __SHAPE_H__
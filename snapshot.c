@@ -0,0 +1,484 @@
+#include "snapshot.h"
+#include "body.h"
+#include "forces.h"
+#include "polygon.h"
+#include "scene.h"
+#include "shape.h"
+#include "snapshot_format.h"
+#include "vector.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// bump whenever a record changes, so old snapshots are rejected
+const uint32_t SNAPSHOT_VERSION = 5;
+// reads back in a different order on a machine with the other byte order
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+const char SNAPSHOT_MAGIC[8] = {'S', 'C', 'E', 'N', 'E', 'S', 'N', 'P'};
+// the body index stored for a force's missing bodies
+const uint64_t NO_BODY = UINT64_MAX;
+
+// body record flags
+const uint32_t BODY_REMOVED = 1;
+const uint32_t BODY_GRAV = 2;
+const uint32_t BODY_PREV = 4;
+const uint32_t BODY_HAS_INFO = 8;
+const uint32_t BODY_ASLEEP = 16;
+const uint32_t BODY_STATIC = 32;
+const uint32_t BODY_CONTINUOUS = 64;
+
+// force record flags
+const uint32_t FORCE_FLAGGED = 1;
+
+// every record is a multiple of 8 bytes, so the sections stay aligned
+typedef struct body_record {
+  vector_t position;
+  vector_t velocity;
+  vector_t force;
+  vector_t impulse;
+  double mass;
+  double angle;
+  double radius;
+  rgb_color_t color;
+  uint32_t kind;
+  uint64_t first_vertex;
+  uint32_t vertex_count;
+  uint32_t flags;
+  uint64_t still_ticks;
+} body_record_t;
+
+typedef struct force_record {
+  uint32_t kind;
+  uint32_t flags;
+  uint64_t body1;
+  uint64_t body2;
+  double constant;
+  double theta;
+} force_record_t;
+
+_Static_assert(sizeof(body_record_t) == 128, "body record is packed");
+_Static_assert(sizeof(force_record_t) == 40, "force record is packed");
+
+// maps pointers, e.g. to bodies, to indices by open addressing
+typedef struct pointer_index {
+  const void **keys;
+  size_t *values;
+  size_t capacity;
+} pointer_index_t;
+
+static void pointer_index_init(pointer_index_t *index, size_t count) {
+  // a power of two at most half full
+  index->capacity = 16;
+  while (index->capacity < 2 * count) {
+    index->capacity *= 2;
+  }
+  index->keys = calloc(index->capacity, sizeof(void *));
+  index->values = malloc(sizeof(size_t) * index->capacity);
+  assert(index->keys != NULL && index->values != NULL);
+}
+
+static size_t pointer_index_slot(pointer_index_t *index, const void *key) {
+  size_t slot =
+      (size_t)(((uintptr_t)key >> 4) * 2654435761u) & (index->capacity - 1);
+  while (index->keys[slot] != NULL && index->keys[slot] != key) {
+    slot = (slot + 1) & (index->capacity - 1);
+  }
+  return slot;
+}
+
+// there must be room for the key, i.e. at most count keys are added
+static void pointer_index_add(pointer_index_t *index, const void *key,
+                              size_t value) {
+  size_t slot = pointer_index_slot(index, key);
+  index->keys[slot] = key;
+  index->values[slot] = value;
+}
+
+static bool pointer_index_get(pointer_index_t *index, const void *key,
+                              size_t *value) {
+  size_t slot = pointer_index_slot(index, key);
+  if (index->keys[slot] == NULL) {
+    return false;
+  }
+  *value = index->values[slot];
+  return true;
+}
+
+static void pointer_index_free(pointer_index_t *index) {
+  free(index->keys);
+  free(index->values);
+}
+
+// the scene's bodies are saved first, then its static bodies
+static body_t *snapshot_body(scene_t *scene, size_t index) {
+  size_t bodies = scene_bodies(scene);
+  return index < bodies ? scene_get_body(scene, index)
+                        : scene_get_static_body(scene, index - bodies);
+}
+
+// maps each body to its index in the snapshot
+static void body_index_init(pointer_index_t *index, scene_t *scene) {
+  size_t count = scene_bodies(scene) + scene_static_bodies(scene);
+  pointer_index_init(index, count);
+  for (size_t i = 0; i < count; i++) {
+    pointer_index_add(index, snapshot_body(scene, i), i);
+  }
+}
+
+// finds a force's body in the scene; false if it is from another scene
+static bool body_index_find(pointer_index_t *index, body_t *body,
+                            uint64_t *found) {
+  if (body == NULL) {
+    *found = NO_BODY;
+    return true;
+  }
+  size_t value;
+  if (!pointer_index_get(index, body, &value)) {
+    return false;
+  }
+  *found = value;
+  return true;
+}
+
+// the number of bodies passed to the create_*() function for a kind
+static size_t force_kind_bodies(force_kind_t kind) {
+  switch (kind) {
+  case FORCE_GRAVITY_FIELD:
+    return 0;
+  case FORCE_DRAG:
+    return 1;
+  default:
+    return 2;
+  }
+}
+
+// circles are saved without the polygon drawn in their place
+static size_t body_saved_vertices(body_t *body) {
+  if (body_get_shape_kind(body) == SHAPE_CIRCLE) {
+    return 0;
+  }
+  return shape_get_vertices(body_get_local_shape(body)).size;
+}
+
+void *scene_snapshot(scene_t *scene, size_t info_size, size_t *size) {
+  snapshot_header_t header;
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = SNAPSHOT_VERSION;
+  header.byte_order = SNAPSHOT_BYTE_ORDER;
+  header.bodies = scene_bodies(scene) + scene_static_bodies(scene);
+  header.forces = 0;
+  header.vertices = 0;
+  header.infos = 0;
+  header.info_size = info_size;
+  header.cell_size = scene_get_cell_size(scene);
+
+  // sizes every section first, so the buffer is allocated once
+  for (size_t i = 0; i < scene_forces(scene); i++) {
+    force_t *force = scene_get_force(scene, i);
+    if (force_is_dead(force)) {
+      continue;
+    }
+    force_params_t params =
+        force_get_params(force_get_forcer(force), force_get_aux(force));
+    if (params.kind == FORCE_UNKNOWN) {
+      return NULL;
+    }
+    header.forces++;
+  }
+  // bodies sharing a shape share its saved vertices too
+  pointer_index_t shapes;
+  pointer_index_init(&shapes, header.bodies);
+  for (size_t i = 0; i < header.bodies; i++) {
+    body_t *body = snapshot_body(scene, i);
+    shape_t *shape = body_get_local_shape(body);
+    size_t first_vertex;
+    if (body_saved_vertices(body) > 0 &&
+        !pointer_index_get(&shapes, shape, &first_vertex)) {
+      pointer_index_add(&shapes, shape, header.vertices);
+      header.vertices += body_saved_vertices(body);
+    }
+    if (info_size > 0 && body_get_info(body) != NULL) {
+      header.infos++;
+    }
+  }
+
+  // info values go last so they need not be padded
+  size_t body_offset = sizeof(snapshot_header_t);
+  size_t force_offset = body_offset + header.bodies * sizeof(body_record_t);
+  size_t vertex_offset = force_offset + header.forces * sizeof(force_record_t);
+  size_t info_offset = vertex_offset + header.vertices * sizeof(vector_t);
+  size_t total = info_offset + header.infos * info_size;
+  char *data = malloc(total);
+  assert(data != NULL);
+  memcpy(data, &header, sizeof(header));
+
+  body_record_t *body_records = (body_record_t *)(data + body_offset);
+  vector_t *vertices = (vector_t *)(data + vertex_offset);
+  char *infos = data + info_offset;
+  for (size_t i = 0; i < header.bodies; i++) {
+    body_t *body = snapshot_body(scene, i);
+    body_record_t *record = &body_records[i];
+    shape_kind_t kind = body_get_shape_kind(body);
+    record->position = body_get_centroid(body);
+    record->velocity = body_get_velocity(body);
+    record->force = body_get_force(body);
+    record->impulse = body_get_impulse(body);
+    record->mass = body_get_mass(body);
+    record->angle = body_get_angle(body);
+    record->radius = kind == SHAPE_CIRCLE ? body_get_radius(body) : 0.0;
+    record->color = body_get_color(body);
+    record->kind = kind;
+    record->first_vertex = 0;
+    record->vertex_count = body_saved_vertices(body);
+    record->flags = (body_is_removed(body) ? BODY_REMOVED : 0) |
+                    (body_get_grav(body) ? BODY_GRAV : 0) |
+                    (body_get_prev_collision(body) ? BODY_PREV : 0) |
+                    (body_is_asleep(body) ? BODY_ASLEEP : 0) |
+                    (body_is_static(body) ? BODY_STATIC : 0) |
+                    (body_is_continuous(body) ? BODY_CONTINUOUS : 0);
+    record->still_ticks = body_get_still_ticks(body);
+    if (record->vertex_count > 0) {
+      shape_t *shape = body_get_local_shape(body);
+      size_t first_vertex;
+      pointer_index_get(&shapes, shape, &first_vertex);
+      record->first_vertex = first_vertex;
+      // a shared shape is copied once per body, but always to the same place
+      memcpy(&vertices[first_vertex], shape_get_vertices(shape).data,
+             sizeof(vector_t) * record->vertex_count);
+    }
+    if (info_size > 0 && body_get_info(body) != NULL) {
+      record->flags |= BODY_HAS_INFO;
+      memcpy(infos, body_get_info(body), info_size);
+      infos += info_size;
+    }
+  }
+
+  pointer_index_free(&shapes);
+
+  pointer_index_t index;
+  body_index_init(&index, scene);
+  force_record_t *force_records = (force_record_t *)(data + force_offset);
+  size_t next_force = 0;
+  for (size_t i = 0; i < scene_forces(scene); i++) {
+    force_t *force = scene_get_force(scene, i);
+    if (force_is_dead(force)) {
+      continue;
+    }
+    force_params_t params =
+        force_get_params(force_get_forcer(force), force_get_aux(force));
+    force_record_t *record = &force_records[next_force++];
+    record->kind = params.kind;
+    record->flags = params.flagged ? FORCE_FLAGGED : 0;
+    record->constant = params.constant;
+    record->theta = params.theta;
+    if (!body_index_find(&index, params.body1, &record->body1) ||
+        !body_index_find(&index, params.body2, &record->body2)) {
+      // the force links this scene to another one
+      pointer_index_free(&index);
+      free(data);
+      return NULL;
+    }
+  }
+  pointer_index_free(&index);
+
+  *size = total;
+  return data;
+}
+
+// checks a snapshot's header and that its sections fit in the buffer
+static bool snapshot_valid(const snapshot_header_t *header, size_t size) {
+  if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+      header->version != SNAPSHOT_VERSION ||
+      header->byte_order != SNAPSHOT_BYTE_ORDER ||
+      !(header->cell_size > 0) || header->infos > header->bodies) {
+    return false;
+  }
+  // divides instead of multiplying so huge counts cannot overflow
+  size_t left = size - sizeof(snapshot_header_t);
+  if (header->bodies > left / sizeof(body_record_t)) {
+    return false;
+  }
+  left -= header->bodies * sizeof(body_record_t);
+  if (header->forces > left / sizeof(force_record_t)) {
+    return false;
+  }
+  left -= header->forces * sizeof(force_record_t);
+  if (header->vertices > left / sizeof(vector_t)) {
+    return false;
+  }
+  left -= header->vertices * sizeof(vector_t);
+  if (header->info_size > 0 && header->infos > left / header->info_size) {
+    return false;
+  }
+  return left == header->infos * header->info_size;
+}
+
+static bool body_record_valid(const snapshot_header_t *header,
+                              const body_record_t *record) {
+  if (record->first_vertex > header->vertices ||
+      record->vertex_count > header->vertices - record->first_vertex) {
+    return false;
+  }
+  switch (record->kind) {
+  case SHAPE_CIRCLE:
+    return record->radius > 0.0 && record->vertex_count == 0;
+  case SHAPE_BOX:
+    return record->vertex_count == 4;
+  case SHAPE_POLYGON:
+    return record->vertex_count > 0;
+  default:
+    return false;
+  }
+}
+
+static bool force_record_valid(const snapshot_header_t *header,
+                               const force_record_t *record) {
+  if (record->kind <= FORCE_UNKNOWN ||
+      record->kind > FORCE_PHYSICS_COLLISION) {
+    return false;
+  }
+  size_t bodies = force_kind_bodies(record->kind);
+  return (bodies < 1 ? record->body1 == NO_BODY
+                     : record->body1 < header->bodies) &&
+         (bodies < 2 ? record->body2 == NO_BODY
+                     : record->body2 < header->bodies);
+}
+
+// gets the shape for a body record, reusing the one made for an earlier
+// record with the same vertices. Returns a new reference
+static shape_t *restore_shape(shape_t **shapes, const char *vertex_data,
+                              const body_record_t *record) {
+  shape_t *shape = shapes[record->first_vertex];
+  if (shape != NULL &&
+      shape_get_vertices(shape).size == record->vertex_count) {
+    return shape_retain(shape);
+  }
+  vector_t *points = malloc(sizeof(vector_t) * record->vertex_count);
+  assert(points != NULL);
+  memcpy(points, vertex_data + record->first_vertex * sizeof(vector_t),
+         sizeof(vector_t) * record->vertex_count);
+  shape = shape_init_vertices(
+      (vertices_t){.data = points, .size = record->vertex_count,
+                   .normals = NULL},
+      record->kind == SHAPE_BOX ? SHAPE_BOX : SHAPE_POLYGON);
+  if (shapes[record->first_vertex] == NULL) {
+    shapes[record->first_vertex] = shape_retain(shape);
+  }
+  return shape;
+}
+
+scene_t *scene_restore(const void *data, size_t size) {
+  if (size < sizeof(snapshot_header_t)) {
+    return NULL;
+  }
+  snapshot_header_t header;
+  memcpy(&header, data, sizeof(header));
+  if (!snapshot_valid(&header, size)) {
+    return NULL;
+  }
+
+  // the caller's buffer may not be aligned, so records are copied out
+  const char *bytes = data;
+  const char *body_data = bytes + sizeof(snapshot_header_t);
+  const char *force_data = body_data + header.bodies * sizeof(body_record_t);
+  const char *vertex_data =
+      force_data + header.forces * sizeof(force_record_t);
+  const char *info_data = vertex_data + header.vertices * sizeof(vector_t);
+  // each record flagged with info takes the next info value, so there must
+  // be exactly as many as there are values
+  size_t infos = 0;
+  for (size_t i = 0; i < header.bodies; i++) {
+    body_record_t record;
+    memcpy(&record, body_data + i * sizeof(record), sizeof(record));
+    if (!body_record_valid(&header, &record)) {
+      return NULL;
+    }
+    infos += (record.flags & BODY_HAS_INFO) ? 1 : 0;
+  }
+  if (infos != header.infos) {
+    return NULL;
+  }
+  for (size_t i = 0; i < header.forces; i++) {
+    force_record_t record;
+    memcpy(&record, force_data + i * sizeof(record), sizeof(record));
+    if (!force_record_valid(&header, &record)) {
+      return NULL;
+    }
+  }
+
+  scene_t *scene = scene_init();
+  scene_set_cell_size(scene, header.cell_size);
+  // the shape starting at each saved vertex, so bodies that shared a shape
+  // when saved share one again
+  shape_t **shapes = calloc(header.vertices + 1, sizeof(shape_t *));
+  // static bodies are kept apart in the scene, so forces find them here
+  body_t **bodies = malloc(sizeof(body_t *) * (header.bodies + 1));
+  assert(shapes != NULL && bodies != NULL);
+  for (size_t i = 0; i < header.bodies; i++) {
+    body_record_t record;
+    memcpy(&record, body_data + i * sizeof(record), sizeof(record));
+    shape_t *shape = record.vertex_count > 0
+                         ? restore_shape(shapes, vertex_data, &record)
+                         : NULL;
+    void *info = NULL;
+    if (record.flags & BODY_HAS_INFO) {
+      info = malloc(header.info_size);
+      assert(info != NULL);
+      memcpy(info, info_data, header.info_size);
+      info_data += header.info_size;
+    }
+    body_t *body = body_init_exact(record.kind, shape, record.radius,
+                                   record.position, record.angle, record.mass,
+                                   record.color, info,
+                                   info != NULL ? free : NULL);
+    if (shape != NULL) {
+      shape_release(shape);
+    }
+    body_set_velocity(body, record.velocity);
+    body_set_grav(body, record.flags & BODY_GRAV);
+    body_set_prev_collision(body, record.flags & BODY_PREV);
+    body_set_continuous(body, record.flags & BODY_CONTINUOUS);
+    if (record.flags & BODY_ASLEEP) {
+      body_sleep(body);
+    }
+    // a sleeping body may have small pushes waiting, which sleeping would
+    // clear, and which are too small to wake it again
+    body_add_force(body, record.force);
+    body_add_impulse(body, record.impulse);
+    // after everything that wakes the body, which resets the count
+    body_set_still_ticks(body, record.still_ticks);
+    if (record.flags & BODY_REMOVED) {
+      body_remove(body);
+    }
+    if (record.flags & BODY_STATIC) {
+      scene_add_static_body(scene, body);
+    } else {
+      scene_add_body(scene, body);
+    }
+    bodies[i] = body;
+  }
+
+  for (size_t i = 0; i <= header.vertices; i++) {
+    if (shapes[i] != NULL) {
+      shape_release(shapes[i]);
+    }
+  }
+  free(shapes);
+
+  for (size_t i = 0; i < header.forces; i++) {
+    force_record_t record;
+    memcpy(&record, force_data + i * sizeof(record), sizeof(record));
+    force_params_t params = {
+        .kind = record.kind,
+        .body1 = record.body1 == NO_BODY ? NULL : bodies[record.body1],
+        .body2 = record.body2 == NO_BODY ? NULL : bodies[record.body2],
+        .constant = record.constant,
+        .theta = record.theta,
+        .flagged = record.flags & FORCE_FLAGGED};
+    create_force_from_params(scene, params);
+  }
+  free(bodies);
+  return scene;
+}
@@ -0,0 +1,52 @@
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include "scene.h"
+#include <stddef.h>
+
+/**
+ * Scene snapshots: a scene's bodies and built-in forces saved to one
+ * contiguous buffer, e.g. to rewind a game or to send it elsewhere.
+ *
+ * The buffer starts with a versioned header, followed by fixed-size records
+ * for the bodies and forces, the bodies' vertices relative to their
+ * centroids and their info values.
+ * Bodies sharing a shape (see body_init_shared()) are saved with one copy
+ * of its vertices and share a shape again when restored.
+ * Numbers are stored in the machine's own byte order; a snapshot from a
+ * machine with a different order is rejected rather than converted.
+ *
+ * Restoring a snapshot gives a scene that ticks exactly like the saved one,
+ * with one caveat: the broad phase visits pairs in an order that depends on
+ * where the bodies are in memory, so a body touching several others at once
+ * may have its collision handlers called in a different order.
+ */
+
+/**
+ * Saves a scene to a newly allocated buffer, which must be free()d.
+ * Every body is saved, static or not, including its velocity and the forces
+ * and impulses added since the last tick. Forces added with a create_*() function in
+ * forces.h are saved in order; other force creators cannot be, so scenes
+ * with them are not saved. Info values are saved as info_size raw bytes,
+ * so they must not contain pointers.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param info_size the number of bytes of each body's info to save,
+ *   or 0 to restore every body without info
+ * @param size where to store the size of the buffer in bytes
+ * @return the buffer, or NULL if the scene has a force that cannot be saved
+ */
+void *scene_snapshot(scene_t *scene, size_t info_size, size_t *size);
+
+/**
+ * Creates a scene from a buffer returned by scene_snapshot().
+ * Each restored info value is a malloc()ed copy of the saved bytes,
+ * freed with free() along with its body.
+ *
+ * @param data the buffer
+ * @param size the size of the buffer in bytes
+ * @return the new scene, or NULL if the buffer is not a valid snapshot
+ */
+scene_t *scene_restore(const void *data, size_t size);
+
+#endif // #ifndef __SNAPSHOT_H__
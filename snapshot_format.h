@@ -0,0 +1,35 @@
+#ifndef __SNAPSHOT_FORMAT_H__
+#define __SNAPSHOT_FORMAT_H__
+
+#include <stdint.h>
+
+/**
+ * The header at the start of every buffer written by scene_snapshot()
+ * (see snapshot.h). The records and values it counts follow it in order:
+ * body records, force records, vertices and info values.
+ * Every record is a multiple of 8 bytes, so the sections stay aligned.
+ */
+typedef struct snapshot_header {
+  /** "SCENESNP", marking the buffer as a snapshot */
+  char magic[8];
+  /** The format version, bumped whenever a record changes */
+  uint32_t version;
+  /** 0x01020304, to tell the byte order of the machine that saved it */
+  uint32_t byte_order;
+  /** The number of body records */
+  uint64_t bodies;
+  /** The number of force records */
+  uint64_t forces;
+  /** The number of vertices, shared by all body records */
+  uint64_t vertices;
+  /** The number of info values, one per body record flagged as having info */
+  uint64_t infos;
+  /** The size of each info value in bytes */
+  uint64_t info_size;
+  /** The scene's collision grid cell size */
+  double cell_size;
+} snapshot_header_t;
+
+_Static_assert(sizeof(snapshot_header_t) == 64, "snapshot header is packed");
+
+#endif // #ifndef __SNAPSHOT_FORMAT_H__
@@ -206,6 +206,8 @@ void make_user_projectile(state_t *state) {
                                 MAIN_BODY_COLOR);
   scene_add_body(state->body_list, proj);
   body_set_velocity(proj, PROJECTILE_VELOCITY);
+  // projectiles are thin and fast, so they are swept to hit what they pass
+  body_set_continuous(proj, true);
 
   for (size_t i = 1; i < scene_bodies(state->body_list); i++) {
     assert(scene_get_body(state->body_list, i) != NULL);
@@ -232,6 +234,7 @@ void make_enemy_projectile(state_t *state) {
   body_t *proj = make_rectangle(curr.x, curr.y, type, INVADER_COLOR);
   scene_add_body(state->body_list, proj);
   body_set_velocity(proj, vec_multiply(-1, PROJECTILE_VELOCITY));
+  body_set_continuous(proj, true);
   create_destructive_collision(state->body_list, proj,
                                scene_get_body(state->body_list, 0));
   if (strcmp((((char *)body_get_info(scene_get_body(state->body_list, 0)))),
@@ -320,8 +323,7 @@ state_t *emscripten_init() {
   spawn_ships(state);
   make_user_projectile(state);
   for (size_t i = 0; i < scene_bodies(state->body_list); i++) {
-    sdl_draw_polygon(body_get_vertices(scene_get_body(state->body_list, i)),
-                     body_get_color(scene_get_body(state->body_list, i)));
+    sdl_draw_body(scene_get_body(state->body_list, i));
   }
   sdl_show();
   sdl_on_key(move_main_body);
@@ -396,8 +398,7 @@ void emscripten_main(state_t *state) {
   clear_space_invaders(state);
   scene_tick(state->body_list, dt);
   for (size_t i = 0; i < scene_bodies(state->body_list); i++) {
-    sdl_draw_polygon(body_get_vertices(scene_get_body(state->body_list, i)),
-                     body_get_color(scene_get_body(state->body_list, i)));
+    sdl_draw_body(scene_get_body(state->body_list, i));
   }
   sdl_show();
 }
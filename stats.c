@@ -0,0 +1,89 @@
+#include "stats.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+// in the same order as stat_t
+const char *const STAT_NAMES[STAT_COUNT] = {
+    "gravity_forces", "spring_forces",  "drag_forces",    "collision_forces",
+    "other_forces",   "collision_tests", "collision_hits", "sat_axes",
+    "bodies_removed", "forces_freed",   "polygons_drawn", "vertices_drawn"};
+
+// force creators may run on several threads, so the counts are atomic
+static atomic_size_t counters[STAT_COUNT];
+static size_t frame = 0;
+
+// where the counters are dumped, and the sums since the last dump
+static FILE *dump_file = NULL;
+static size_t dump_every = 1;
+static stats_format_t dump_format = STATS_FORMAT_CSV;
+static size_t dump_totals[STAT_COUNT];
+static size_t dump_frames = 0;
+
+void stats_add(stat_t stat, size_t n) {
+  // only the totals matter, so the adds need not be ordered
+  atomic_fetch_add_explicit(&counters[stat], n, memory_order_relaxed);
+}
+
+const char *stats_name(stat_t stat) {
+  assert(stat < STAT_COUNT);
+  return STAT_NAMES[stat];
+}
+
+static void dump_write(size_t last_frame) {
+  if (dump_format == STATS_FORMAT_CSV) {
+    fprintf(dump_file, "%zu", last_frame);
+    for (size_t i = 0; i < STAT_COUNT; i++) {
+      fprintf(dump_file, ",%zu", dump_totals[i]);
+    }
+    fprintf(dump_file, "\n");
+  } else {
+    fprintf(dump_file, "{\"frame\":%zu", last_frame);
+    for (size_t i = 0; i < STAT_COUNT; i++) {
+      fprintf(dump_file, ",\"%s\":%zu", STAT_NAMES[i], dump_totals[i]);
+    }
+    fprintf(dump_file, "}\n");
+  }
+  fflush(dump_file);
+}
+
+frame_stats_t stats_end_frame(void) {
+  frame_stats_t stats = {.frame = frame++};
+  for (size_t i = 0; i < STAT_COUNT; i++) {
+    stats.counts[i] =
+        atomic_exchange_explicit(&counters[i], 0, memory_order_relaxed);
+  }
+  if (dump_file == NULL) {
+    return stats;
+  }
+
+  for (size_t i = 0; i < STAT_COUNT; i++) {
+    dump_totals[i] += stats.counts[i];
+  }
+  if (++dump_frames == dump_every) {
+    dump_write(stats.frame);
+    for (size_t i = 0; i < STAT_COUNT; i++) {
+      dump_totals[i] = 0;
+    }
+    dump_frames = 0;
+  }
+  return stats;
+}
+
+void stats_dump(FILE *file, size_t every, stats_format_t format) {
+  assert(every > 0);
+  dump_file = file;
+  dump_every = every;
+  dump_format = format;
+  for (size_t i = 0; i < STAT_COUNT; i++) {
+    dump_totals[i] = 0;
+  }
+  dump_frames = 0;
+  if (file != NULL && format == STATS_FORMAT_CSV) {
+    fprintf(file, "frame");
+    for (size_t i = 0; i < STAT_COUNT; i++) {
+      fprintf(file, ",%s", STAT_NAMES[i]);
+    }
+    fprintf(file, "\n");
+  }
+}
@@ -0,0 +1,124 @@
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * Counters of the work done each frame, e.g. how many collision tests ran,
+ * for finding where a frame's time goes.
+ *
+ * Build with -DSTATS=1 to turn them on. Otherwise STATS_ADD() compiles to
+ * nothing, so the hot paths pay nothing for them and stats.c need not be
+ * linked. Counters may be added to from any thread.
+ */
+#ifndef STATS
+#define STATS 0
+#endif
+// how often the demo drivers dump the counters, and in which format
+#ifndef STATS_DUMP_EVERY
+#define STATS_DUMP_EVERY 60
+#endif
+#ifndef STATS_JSON
+#define STATS_JSON 0
+#endif
+
+/**
+ * The counters. The names used in dumps are the lowercase names
+ * without the STAT_ prefix, e.g. "sat_axes".
+ */
+typedef enum {
+  /** Newtonian gravity and gravity field force creators called */
+  STAT_GRAVITY_FORCES,
+  /** Spring force creators called */
+  STAT_SPRING_FORCES,
+  /** Drag force creators called */
+  STAT_DRAG_FORCES,
+  /** Collision force creators called on pairs the broad phase found */
+  STAT_COLLISION_FORCES,
+  /** Any other force creators called */
+  STAT_OTHER_FORCES,
+  /** Calls to find_collision() and find_body_collision() */
+  STAT_COLLISION_TESTS,
+  /** Calls to find_collision() and find_body_collision() that collided */
+  STAT_COLLISION_HITS,
+  /** Separating axes projected onto by SAT */
+  STAT_SAT_AXES,
+  /** Removed bodies freed by scene_tick() */
+  STAT_BODIES_REMOVED,
+  /** Dead force creators freed by scene_tick() */
+  STAT_FORCES_FREED,
+  /** Polygons, including bodies and circles, submitted for drawing */
+  STAT_POLYGONS_DRAWN,
+  /** Vertices of the polygons submitted for drawing */
+  STAT_VERTICES_DRAWN,
+  STAT_COUNT
+} stat_t;
+
+/**
+ * The counts for one frame.
+ */
+typedef struct {
+  /** The frame's number, starting at 0 */
+  size_t frame;
+  /** The counts, indexed by stat_t */
+  size_t counts[STAT_COUNT];
+} frame_stats_t;
+
+/** The formats stats_dump() can write */
+typedef enum {
+  /** A header row, then one row of comma-separated values per dump */
+  STATS_FORMAT_CSV,
+  /** One JSON object per line per dump */
+  STATS_FORMAT_JSON
+} stats_format_t;
+
+/**
+ * Adds to a counter if stats are turned on; does nothing otherwise.
+ * The arguments are not evaluated when stats are off.
+ */
+#if STATS
+#define STATS_ADD(stat, n) stats_add((stat), (n))
+#else
+#define STATS_ADD(stat, n) ((void)0)
+#endif
+
+/**
+ * Adds to a counter for the current frame. Use STATS_ADD() instead,
+ * so the call disappears when stats are turned off.
+ *
+ * @param stat the counter
+ * @param n the amount to add
+ */
+void stats_add(stat_t stat, size_t n);
+
+/**
+ * Gets the name of a counter, as used in dumps.
+ *
+ * @param stat the counter
+ * @return the counter's name, e.g. "sat_axes"
+ */
+const char *stats_name(stat_t stat);
+
+/**
+ * Ends the current frame, starting the counters from 0 for the next one.
+ * If a dump is set up, writes the counts summed over the last frames
+ * once every so many frames.
+ *
+ * @return the counts for the frame that ended
+ */
+frame_stats_t stats_end_frame(void);
+
+/**
+ * Sets up writing the counters to a file every so many frames,
+ * summed over those frames and labeled with the last frame's number.
+ * A CSV dump writes its header row straight away.
+ *
+ * @param file the file to write to, which must stay open,
+ *   or NULL to stop dumping
+ * @param every the number of frames between dumps; must be positive
+ * @param format the format to write in
+ */
+void stats_dump(FILE *file, size_t every, stats_format_t format);
+
+#endif // #ifndef __STATS_H__
@@ -0,0 +1,290 @@
+// Checks engine behavior that the demos would not notice going wrong.
+// Like headless.c, this is a program of its own; it links against the
+// engine but not against any demo, SDL or emscripten.c.
+// To build and run (the gcc command is a single line):
+//
+//   gcc -O2 -pthread -o tests tests.c body.c collision.c forces.c list.c
+//       polygon.c pool.c quadtree.c scene.c shape.c snapshot.c
+//       threadpool.c vector.c -lm
+//   ./tests
+//
+// Each check asserts, so the program aborts at the first failure and
+// prints "all checks passed" otherwise. Do not build it with -DNDEBUG.
+
+#include "body.h"
+#include "collision.h"
+#include "forces.h"
+#include "polygon.h"
+#include "scene.h"
+#include "snapshot.h"
+#include "snapshot_format.h"
+#include "threadpool.h"
+#include "vector.h"
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef NDEBUG
+#error "tests.c checks with assert(), so it must be built without NDEBUG"
+#endif
+
+// convex polygons whose bounding boxes overlap, but which an edge of the
+// first one separates; none of the second one's edges do
+static void check_separated_on_first_edge(void) {
+  vector_t triangle[] = {{0.0, 0.0}, {10.0, 0.0}, {0.0, 10.0}};
+  vector_t square[] = {{8.0, 8.0}, {12.0, 8.0}, {12.0, 12.0}, {8.0, 12.0}};
+  vertices_t shape1 = {.data = triangle, .size = 3, .normals = NULL};
+  vertices_t shape2 = {.data = square, .size = 4, .normals = NULL};
+  assert(aabb_overlap(vertices_bounds(shape1), vertices_bounds(shape2)));
+  assert(!find_collision(shape1, shape2).collided);
+  assert(!find_collision(shape2, shape1).collided);
+}
+
+// the SIMD projection kernel must agree with a plain loop for every size,
+// including the vertices left over after the last full SIMD step
+static void check_projection_parity(void) {
+  vector_t points[17];
+  srand(1);
+  for (size_t size = 1; size <= 17; size++) {
+    for (size_t i = 0; i < size; i++) {
+      points[i] = (vector_t){.x = rand() % 2001 / 10.0 - 100.0,
+                             .y = rand() % 2001 / 10.0 - 100.0};
+    }
+    vertices_t shape = {.data = points, .size = size, .normals = NULL};
+    for (size_t k = 0; k < 8; k++) {
+      vector_t axis = {.x = cos(k * 0.7), .y = sin(k * 0.7)};
+      double min = INFINITY;
+      double max = -INFINITY;
+      for (size_t i = 0; i < size; i++) {
+        double dot = vec_dot(points[i], axis);
+        min = fmin(min, dot);
+        max = fmax(max, dot);
+      }
+      double found_min, found_max;
+      find_projection_bounds(shape, axis, &found_min, &found_max);
+      // allows for a fused multiply-add on one side only
+      assert(fabs(found_min - min) <= 1e-9);
+      assert(fabs(found_max - max) <= 1e-9);
+    }
+  }
+}
+
+// as check_separated_on_first_edge(), but with enough vertices in the first
+// shape for the SIMD kernel to project them
+static void check_simd_separated_on_first_edge(void) {
+  // a regular 16-gon of radius 10 with an edge facing (1, 1)
+  vector_t gon[16];
+  for (size_t i = 0; i < 16; i++) {
+    double angle = (2 * i + 1) * M_PI / 16;
+    gon[i] = (vector_t){.x = 10 * cos(angle), .y = 10 * sin(angle)};
+  }
+  // a square just past that edge, with a corner pointing at it
+  double apothem = 10 * cos(M_PI / 16);
+  double center = (apothem + 2 * sqrt(2) + 0.5) / sqrt(2);
+  vector_t square[] = {{center - 2, center - 2},
+                       {center + 2, center - 2},
+                       {center + 2, center + 2},
+                       {center - 2, center + 2}};
+  vertices_t shape1 = {.data = gon, .size = 16, .normals = NULL};
+  vertices_t shape2 = {.data = square, .size = 4, .normals = NULL};
+  assert(aabb_overlap(vertices_bounds(shape1), vertices_bounds(shape2)));
+  assert(!find_collision(shape1, shape2).collided);
+  assert(!find_collision(shape2, shape1).collided);
+}
+
+// a snapshot with more bodies flagged as having info than it has info
+// values must be rejected, not read past its end
+static void check_snapshot_info_count(void) {
+  scene_t *scene = scene_init();
+  rgb_color_t color = {0.0, 0.0, 0.0};
+  for (int i = 0; i < 2; i++) {
+    int *info = malloc(sizeof(int));
+    assert(info != NULL);
+    *info = i;
+    scene_add_body(scene, body_init_circle((vector_t){.x = i, .y = 0.0}, 1.0,
+                                           1.0, color, info, free));
+  }
+  size_t size;
+  char *data = scene_snapshot(scene, sizeof(int), &size);
+  assert(data != NULL);
+  scene_t *restored = scene_restore(data, size);
+  assert(restored != NULL);
+  scene_free(restored);
+
+  // drops the last info value but leaves both bodies flagged
+  uint64_t infos;
+  size_t infos_offset = offsetof(snapshot_header_t, infos);
+  memcpy(&infos, data + infos_offset, sizeof(infos));
+  assert(infos == 2);
+  infos--;
+  memcpy(data + infos_offset, &infos, sizeof(infos));
+  assert(scene_restore(data, size - sizeof(int)) == NULL);
+  free(data);
+  scene_free(scene);
+}
+
+// a scene of scattered bodies pulling on each other through a gravity field
+static scene_t *gravity_field_scene(size_t count) {
+  scene_t *scene = scene_init();
+  rgb_color_t color = {0.0, 0.0, 0.0};
+  srand(2);
+  for (size_t i = 0; i < count; i++) {
+    vector_t center = {.x = rand() % 10001 / 10.0,
+                       .y = rand() % 10001 / 10.0};
+    scene_add_body(scene, body_init_circle(center, 1.0, 1.0 + rand() % 100,
+                                           color, NULL, NULL));
+  }
+  create_gravity_field(scene, 1000.0, 0.5);
+  return scene;
+}
+
+// splitting a gravity field's bodies across threads must not change a bit
+// of where they end up
+static void check_gravity_field_threads(void) {
+  const size_t BODIES = 500;
+  scene_t *serial = gravity_field_scene(BODIES);
+  scene_set_thread_pool(serial, NULL);
+  scene_t *split = gravity_field_scene(BODIES);
+  thread_pool_t *threads = thread_pool_init(4);
+  scene_set_thread_pool(split, threads);
+  for (size_t tick = 0; tick < 10; tick++) {
+    scene_tick(serial, 0.01);
+    scene_tick(split, 0.01);
+  }
+  for (size_t i = 0; i < BODIES; i++) {
+    vector_t expected = body_get_centroid(scene_get_body(serial, i));
+    vector_t found = body_get_centroid(scene_get_body(split, i));
+    assert(memcmp(&expected, &found, sizeof(vector_t)) == 0);
+  }
+  scene_free(serial);
+  scene_free(split);
+  thread_pool_free(threads);
+}
+
+// a force in one scene on bodies of another must be dropped, not run on
+// freed bodies, when the other scene is reset or freed
+static void check_cross_scene_force(bool reset) {
+  scene_t *owner = scene_init();
+  scene_t *other = scene_init();
+  rgb_color_t color = {0.0, 0.0, 0.0};
+  body_t *body1 = body_init_circle(VEC_ZERO, 1.0, 1.0, color, NULL, NULL);
+  body_t *body2 = body_init_circle((vector_t){.x = 10.0, .y = 0.0}, 1.0, 1.0,
+                                   color, NULL, NULL);
+  scene_add_body(owner, body1);
+  scene_add_body(owner, body2);
+  create_newtonian_gravity(other, 1.0, body1, body2);
+  scene_tick(other, 0.01);
+  assert(scene_forces(other) == 1);
+  if (reset) {
+    scene_reset(owner);
+  } else {
+    scene_free(owner);
+  }
+  scene_tick(other, 0.01);
+  assert(scene_forces(other) == 0);
+  if (reset) {
+    scene_free(owner);
+  }
+  scene_free(other);
+}
+
+// the grid only makes its buckets as bodies are inserted, so changing the
+// cell size or freeing the scene must cope with buckets never made
+static void check_grid_buckets(void) {
+  scene_t *scene = scene_init();
+  scene_set_cell_size(scene, 5.0);
+  rgb_color_t color = {0.0, 0.0, 0.0};
+  body_t *body1 = body_init_circle(VEC_ZERO, 1.0, 1.0, color, NULL, NULL);
+  body_t *body2 = body_init_circle((vector_t){.x = 1.5, .y = 0.0}, 1.0, 1.0,
+                                   color, NULL, NULL);
+  body_set_velocity(body2, (vector_t){.x = -1.0, .y = 0.0});
+  scene_add_body(scene, body1);
+  scene_add_body(scene, body2);
+  create_physics_collision(scene, 1.0, body1, body2);
+  scene_tick(scene, 0.01);
+  assert(body_get_velocity(body2).x != -1.0);
+  scene_set_cell_size(scene, 50.0);
+  scene_tick(scene, 0.01);
+  scene_free(scene);
+  scene_free(scene_init());
+}
+
+// pushes too small to wake a sleeping body on their own must add up until
+// together they do, rather than being dropped
+static void check_sleeping_pushes(void) {
+  rgb_color_t color = {0.0, 0.0, 0.0};
+  body_t *body = body_init_circle(VEC_ZERO, 1.0, 2.0, color, NULL, NULL);
+  body_sleep(body);
+  vector_t force = {.x = 0.6 * SLEEP_ACCELERATION * 2.0, .y = 0.0};
+  body_add_force(body, force);
+  assert(body_is_asleep(body));
+  body_add_force(body, force);
+  assert(!body_is_asleep(body));
+  assert(body_get_force(body).x == 2 * force.x);
+
+  body_tick(body, 1.0);
+  body_sleep(body);
+  vector_t impulse = {.x = 0.0, .y = 0.6 * SLEEP_SPEED * 2.0};
+  body_add_impulse(body, impulse);
+  assert(body_is_asleep(body));
+  body_add_impulse(body, impulse);
+  assert(!body_is_asleep(body));
+  assert(body_get_impulse(body).y == 2 * impulse.y);
+  body_free(body);
+}
+
+// a diamond of the given radius as a body, so collisions with it use SAT.
+// Repeating a corner gives it a zero-length edge, as some demos' shapes have
+static body_t *diamond_body(vector_t center, double radius, bool repeat) {
+  list_t *points = list_init(5, free);
+  vector_t corners[] = {{radius, 0.0}, {0.0, radius}, {-radius, 0.0},
+                        {0.0, -radius}, {0.0, -radius}};
+  for (size_t i = 0; i < (repeat ? 5 : 4); i++) {
+    vector_t *point = malloc(sizeof(vector_t));
+    assert(point != NULL);
+    *point = vec_add(center, corners[i]);
+    list_add(points, point);
+  }
+  return body_init(points, 1.0, (rgb_color_t){0.0, 0.0, 0.0});
+}
+
+// sweeping a polygon moves its projections rather than its vertices, which
+// must find the same first touch as moving the vertices would
+static void check_polygon_time_of_impact(bool repeat) {
+  body_t *moving = diamond_body((vector_t){.x = 20.0, .y = 0.0}, 1.0, false);
+  body_t *target = diamond_body((vector_t){.x = 10.0, .y = 0.0}, 1.0, repeat);
+  vertices_t before = body_get_vertices(moving);
+  vector_t first = before.data[0];
+  // touches once the moving diamond's center reaches x = 8
+  double time = find_time_of_impact(moving, VEC_ZERO,
+                                    (vector_t){.x = 20.0, .y = 0.0}, target);
+  assert(time >= 0.4 && time < 0.4 + 1e-3);
+  assert(find_time_of_impact(moving, (vector_t){.x = 0.0, .y = 5.0},
+                             (vector_t){.x = 20.0, .y = 5.0},
+                             target) == INFINITY);
+  // the swept body is left where it was
+  vertices_t after = body_get_vertices(moving);
+  assert(after.data[0].x == first.x && after.data[0].y == first.y);
+  body_free(moving);
+  body_free(target);
+}
+
+int main(void) {
+  check_separated_on_first_edge();
+  check_projection_parity();
+  check_simd_separated_on_first_edge();
+  check_snapshot_info_count();
+  check_gravity_field_threads();
+  check_cross_scene_force(true);
+  check_cross_scene_force(false);
+  check_grid_buckets();
+  check_sleeping_pushes();
+  check_polygon_time_of_impact(false);
+  check_polygon_time_of_impact(true);
+  printf("all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include "threadpool.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct thread_pool {
+  size_t num_threads;
+  // the num_threads - 1 workers; the caller of thread_pool_run() is the last
+  pthread_t *workers;
+  // held for the whole of a run, so only one job uses the workers at a time
+  pthread_mutex_t run_lock;
+  // guards everything below except next
+  pthread_mutex_t lock;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  job_func_t job;
+  void *aux;
+  size_t count;
+  // the next piece to hand out
+  atomic_size_t next;
+  // bumped for every job, so workers can tell a new job from a spurious wakeup
+  size_t generation;
+  // workers that have not finished the current job
+  size_t active;
+  bool stopping;
+} thread_pool_t;
+
+// runs pieces of the current job until there are none left
+static void thread_pool_work(thread_pool_t *pool) {
+  for (size_t i = atomic_fetch_add(&pool->next, 1); i < pool->count;
+       i = atomic_fetch_add(&pool->next, 1)) {
+    pool->job(pool->aux, i);
+  }
+}
+
+static void *thread_pool_worker(void *arg) {
+  thread_pool_t *pool = arg;
+  size_t seen = 0;
+  pthread_mutex_lock(&pool->lock);
+  while (true) {
+    while (pool->generation == seen && !pool->stopping) {
+      pthread_cond_wait(&pool->start, &pool->lock);
+    }
+    if (pool->stopping) {
+      break;
+    }
+    seen = pool->generation;
+    pthread_mutex_unlock(&pool->lock);
+    thread_pool_work(pool);
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->active == 0) {
+      pthread_cond_signal(&pool->done);
+    }
+  }
+  pthread_mutex_unlock(&pool->lock);
+  return NULL;
+}
+
+thread_pool_t *thread_pool_init(size_t threads) {
+  if (threads == 0) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = online > 0 ? (size_t)online : 1;
+  }
+  thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+  assert(pool != NULL);
+  pool->num_threads = threads;
+  pool->workers = malloc(sizeof(pthread_t) * (threads > 1 ? threads - 1 : 1));
+  assert(pool->workers != NULL);
+  pthread_mutex_init(&pool->run_lock, NULL);
+  pthread_mutex_init(&pool->lock, NULL);
+  pthread_cond_init(&pool->start, NULL);
+  pthread_cond_init(&pool->done, NULL);
+  pool->job = NULL;
+  pool->aux = NULL;
+  pool->count = 0;
+  atomic_init(&pool->next, 0);
+  pool->generation = 0;
+  pool->active = 0;
+  pool->stopping = false;
+  for (size_t i = 0; i + 1 < threads; i++) {
+    int error =
+        pthread_create(&pool->workers[i], NULL, thread_pool_worker, pool);
+    assert(error == 0);
+  }
+  return pool;
+}
+
+void thread_pool_free(thread_pool_t *pool) {
+  pthread_mutex_lock(&pool->lock);
+  pool->stopping = true;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+  for (size_t i = 0; i + 1 < pool->num_threads; i++) {
+    pthread_join(pool->workers[i], NULL);
+  }
+  pthread_cond_destroy(&pool->done);
+  pthread_cond_destroy(&pool->start);
+  pthread_mutex_destroy(&pool->lock);
+  pthread_mutex_destroy(&pool->run_lock);
+  free(pool->workers);
+  free(pool);
+}
+
+size_t thread_pool_threads(thread_pool_t *pool) { return pool->num_threads; }
+
+void thread_pool_run(thread_pool_t *pool, job_func_t job, void *aux,
+                     size_t count) {
+  // a busy or single-threaded pool runs the job here, in order
+  if (count <= 1 || pool->num_threads == 1 ||
+      pthread_mutex_trylock(&pool->run_lock) != 0) {
+    for (size_t i = 0; i < count; i++) {
+      job(aux, i);
+    }
+    return;
+  }
+
+  pthread_mutex_lock(&pool->lock);
+  pool->job = job;
+  pool->aux = aux;
+  pool->count = count;
+  atomic_store(&pool->next, 0);
+  pool->active = pool->num_threads - 1;
+  pool->generation++;
+  pthread_cond_broadcast(&pool->start);
+  pthread_mutex_unlock(&pool->lock);
+
+  thread_pool_work(pool);
+
+  pthread_mutex_lock(&pool->lock);
+  while (pool->active > 0) {
+    pthread_cond_wait(&pool->done, &pool->lock);
+  }
+  pthread_mutex_unlock(&pool->lock);
+  pthread_mutex_unlock(&pool->run_lock);
+}
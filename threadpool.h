@@ -0,0 +1,62 @@
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+#include <stddef.h>
+
+/**
+ * A fixed set of worker threads that run jobs split into numbered pieces.
+ * The thread that starts a job works on it too, so a pool of n threads
+ * starts n - 1 workers. Pieces are handed out in no particular order,
+ * so callers that need deterministic results should write each piece's
+ * output to its own slot and combine the slots afterwards.
+ */
+typedef struct thread_pool thread_pool_t;
+
+/**
+ * A piece of a job.
+ *
+ * @param aux the aux value passed to thread_pool_run()
+ * @param index which piece to run, from 0 up to the number of pieces
+ */
+typedef void (*job_func_t)(void *aux, size_t index);
+
+/**
+ * Allocates memory for a thread pool and starts its workers.
+ * Asserts that the required memory is allocated and the threads start.
+ *
+ * @param threads the number of threads to run jobs on, including the caller;
+ *   0 means one per online processor
+ * @return a pointer to the newly allocated pool
+ */
+thread_pool_t *thread_pool_init(size_t threads);
+
+/**
+ * Stops a pool's workers and releases the memory allocated for it.
+ * Must not be called while a job is running.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ */
+void thread_pool_free(thread_pool_t *pool);
+
+/**
+ * Gets the number of threads a pool runs jobs on, including the caller.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ * @return the number of threads
+ */
+size_t thread_pool_threads(thread_pool_t *pool);
+
+/**
+ * Runs job(aux, i) for every i below count and waits for all of them.
+ * If the pool is already running a job, e.g. one started by another thread
+ * or by the job itself, the pieces run on the calling thread instead.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ * @param job the function to run for each piece
+ * @param aux the value passed to every call of job
+ * @param count the number of pieces
+ */
+void thread_pool_run(thread_pool_t *pool, job_func_t job, void *aux,
+                     size_t count);
+
+#endif // #ifndef __THREADPOOL_H__
@@ -0,0 +1,67 @@
+#include "trace.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+typedef struct trace_event {
+  const char *name;
+  uint64_t start;
+  uint64_t duration;
+  size_t thread;
+} trace_event_t;
+
+// the last TRACE_ZONES zones; next_event counts every zone ever ended,
+// so the oldest one still kept is next_event - TRACE_ZONES
+static trace_event_t events[TRACE_ZONES];
+static atomic_size_t next_event = 0;
+
+// threads are numbered in the order they first end a zone, starting at 1
+static atomic_size_t next_thread = 1;
+static _Thread_local size_t thread_number = 0;
+
+static uint64_t trace_now(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (uint64_t)time.tv_sec * 1000000000u + time.tv_nsec;
+}
+
+trace_zone_t trace_begin(const char *name) {
+  return (trace_zone_t){.name = name, .start = trace_now()};
+}
+
+void trace_end(trace_zone_t zone) {
+  uint64_t end = trace_now();
+  if (thread_number == 0) {
+    thread_number = atomic_fetch_add(&next_thread, 1);
+  }
+  // each zone gets its own slot, so threads only contend on the counter
+  size_t index = atomic_fetch_add_explicit(&next_event, 1,
+                                           memory_order_relaxed);
+  events[index % TRACE_ZONES] = (trace_event_t){.name = zone.name,
+                                                .start = zone.start,
+                                                .duration = end - zone.start,
+                                                .thread = thread_number};
+}
+
+bool trace_export(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    return false;
+  }
+  size_t end = atomic_load(&next_event);
+  size_t start = end > TRACE_ZONES ? end - TRACE_ZONES : 0;
+  fprintf(file, "{\"traceEvents\":[");
+  for (size_t i = start; i < end; i++) {
+    trace_event_t *event = &events[i % TRACE_ZONES];
+    // complete events, with times in microseconds
+    fprintf(file,
+            "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+            "\"pid\":1,\"tid\":%zu}",
+            i == start ? "" : ",", event->name, event->start / 1e3,
+            event->duration / 1e3, event->thread);
+  }
+  fprintf(file, "\n],\"displayTimeUnit\":\"ns\"}\n");
+  return fclose(file) == 0;
+}
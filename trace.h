@@ -0,0 +1,78 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Timed zones around the engine's hot paths, e.g. each phase of
+ * scene_tick(), for seeing where a frame's time goes in a trace viewer
+ * such as chrome://tracing or Perfetto.
+ *
+ * Build with -DTRACE=1 to turn them on. Otherwise TRACE_BEGIN() and
+ * TRACE_END() compile to nothing and trace.c need not be linked.
+ * Zones are timed with a monotonic clock and kept in a ring buffer of the
+ * last TRACE_ZONES zones, from any thread, until trace_export() writes them.
+ */
+#ifndef TRACE
+#define TRACE 0
+#endif
+#ifndef TRACE_ZONES
+#define TRACE_ZONES 65536
+#endif
+// where the demo drivers write the trace when they exit
+#ifndef TRACE_FILE
+#define TRACE_FILE "trace.json"
+#endif
+
+/**
+ * A zone that has begun but not ended.
+ */
+typedef struct {
+  /** The zone's name, shown in the trace viewer */
+  const char *name;
+  /** When the zone began, in nanoseconds since an arbitrary point */
+  uint64_t start;
+} trace_zone_t;
+
+/**
+ * Begins a zone, declaring a variable for TRACE_END() to end it with.
+ * Zones on one thread must end in the reverse order they began.
+ * Does nothing if tracing is turned off.
+ */
+#if TRACE
+#define TRACE_BEGIN(zone, name) trace_zone_t zone = trace_begin(name)
+#define TRACE_END(zone) trace_end(zone)
+#else
+#define TRACE_BEGIN(zone, name) ((void)0)
+#define TRACE_END(zone) ((void)0)
+#endif
+
+/**
+ * Begins a zone. Use TRACE_BEGIN() instead,
+ * so the call disappears when tracing is turned off.
+ *
+ * @param name the zone's name, which must be a string literal or otherwise
+ *   outlive the trace, and must not need escaping in JSON
+ * @return the zone, to pass to trace_end()
+ */
+trace_zone_t trace_begin(const char *name);
+
+/**
+ * Ends a zone and adds it to the ring buffer, overwriting the oldest zone
+ * if the buffer is full. Use TRACE_END() instead.
+ *
+ * @param zone the zone returned from trace_begin()
+ */
+void trace_end(trace_zone_t zone);
+
+/**
+ * Writes the zones in the ring buffer to a file as Chrome trace-event JSON,
+ * oldest first. Must not be called while other threads are ending zones.
+ *
+ * @param path the file to write to, which is replaced
+ * @return whether the file could be written
+ */
+bool trace_export(const char *path);
+
+#endif // #ifndef __TRACE_H__